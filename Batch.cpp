@@ -0,0 +1,483 @@
+#include "pch.h"
+#include "Batch.h"
+#include "CharScan.h"
+
+#if !defined(EDE_NO_SIMD) && (defined(_M_X64) || defined(__x86_64__))
+#define EDE_BATCH_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace ede::batch
+{
+	//Computes _count lanes of _destination from the lanes of _left and _right, which it may alias. Lanes that
+	//fail get their EvalStatus in _status, which is left untouched otherwise; returns true if any lane failed.
+	typedef bool (*Kernel)(uint64_t* _destination, const uint64_t* _left, const uint64_t* _right, size_t _count, uint8_t* _status);
+
+#pragma region Scalar
+	//Lanes of FLOAT columns hold the bits of the double
+	inline FLOAT LoadFloat(const uint64_t* _lane) { FLOAT value; std::memcpy(&value, _lane, sizeof(value)); return value; }
+	inline void StoreFloat(uint64_t* _lane, FLOAT _value) { std::memcpy(_lane, &_value, sizeof(_value)); }
+
+	//Operands may be the caller's INT columns, read in place; they are never accessed as uint64_t
+	inline INT LoadInt(const uint64_t* _lane) { INT value; std::memcpy(&value, _lane, sizeof(value)); return value; }
+
+	template<BinopOP OP>
+	bool IntScalar(uint64_t* _destination, const uint64_t* _left, const uint64_t* _right, size_t _count, uint8_t* _status)
+	{
+		bool failed = false;
+
+		for (size_t i = 0; i < _count; i++)
+		{
+			INT result = 0;
+			EvalStatus status = IntBinop(OP, LoadInt(&_left[i]), LoadInt(&_right[i]), result);
+			_destination[i] = (uint64_t)result;
+
+			if (status != EvalStatus::OK)
+			{
+				_status[i] = (uint8_t)status;
+				failed = true;
+			}
+		}
+
+		return failed;
+	}
+
+	template<BinopOP OP>
+	bool FloatScalar(uint64_t* _destination, const uint64_t* _left, const uint64_t* _right, size_t _count, uint8_t*)
+	{
+		for (size_t i = 0; i < _count; i++)
+			StoreFloat(&_destination[i], FloatBinop(OP, LoadFloat(&_left[i]), LoadFloat(&_right[i])));
+
+		return false;
+	}
+
+	//Binops the checker could not type never reach a plan; fail every lane rather than guess
+	bool InvalidScalar(uint64_t* _destination, const uint64_t*, const uint64_t*, size_t _count, uint8_t* _status)
+	{
+		std::fill(_destination, _destination + _count, 0);
+		std::fill(_status, _status + _count, (uint8_t)EvalStatus::INVALID_OPERANDS);
+		return _count != 0;
+	}
+#pragma endregion
+
+#ifdef EDE_BATCH_X64
+	inline void FlagOverflows(uint8_t* _status, int _mask)
+	{
+		for (int lane = 0; _mask; lane++, _mask >>= 1)
+		{
+			if (_mask & 1) { _status[lane] = (uint8_t)EvalStatus::INTEGER_OVERFLOW; }
+		}
+	}
+
+#pragma region SSE2
+	//Signed overflow of a + b or a - b shows in the sign bit: the operands agree in sign and the result does not
+	template<BinopOP OP>
+	bool IntSse2(uint64_t* _destination, const uint64_t* _left, const uint64_t* _right, size_t _count, uint8_t* _status)
+	{
+		bool failed = false;
+		size_t i = 0;
+
+		for (; i + 2 <= _count; i += 2)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i*)(_left + i)), b = _mm_loadu_si128((const __m128i*)(_right + i));
+			__m128i result = OP == BinopOP::ADD ? _mm_add_epi64(a, b) : _mm_sub_epi64(a, b);
+			__m128i overflow = OP == BinopOP::ADD ? _mm_and_si128(_mm_xor_si128(a, result), _mm_xor_si128(b, result)) : _mm_and_si128(_mm_xor_si128(a, b), _mm_xor_si128(a, result));
+			_mm_storeu_si128((__m128i*)(_destination + i), result);
+
+			if (int mask = _mm_movemask_pd(_mm_castsi128_pd(overflow)))
+			{
+				FlagOverflows(_status + i, mask);
+				failed = true;
+			}
+		}
+
+		return IntScalar<OP>(_destination + i, _left + i, _right + i, _count - i, _status + i) || failed;
+	}
+
+	template<BinopOP OP>
+	bool FloatSse2(uint64_t* _destination, const uint64_t* _left, const uint64_t* _right, size_t _count, uint8_t* _status)
+	{
+		size_t i = 0;
+
+		for (; i + 2 <= _count; i += 2)
+		{
+			__m128d a = _mm_loadu_pd((const double*)(_left + i)), b = _mm_loadu_pd((const double*)(_right + i)), result;
+
+			switch (OP)
+			{
+				case BinopOP::ADD: result = _mm_add_pd(a, b); break;
+				case BinopOP::SUB: result = _mm_sub_pd(a, b); break;
+				case BinopOP::MUL: result = _mm_mul_pd(a, b); break;
+				default: result = _mm_div_pd(a, b); break;
+			}
+
+			_mm_storeu_pd((double*)(_destination + i), result);
+		}
+
+		return FloatScalar<OP>(_destination + i, _left + i, _right + i, _count - i, _status + i);
+	}
+#pragma endregion
+
+#pragma region AVX2
+	template<BinopOP OP>
+	TARGET_AVX2 bool IntAvx2(uint64_t* _destination, const uint64_t* _left, const uint64_t* _right, size_t _count, uint8_t* _status)
+	{
+		bool failed = false;
+		size_t i = 0;
+
+		for (; i + 4 <= _count; i += 4)
+		{
+			__m256i a = _mm256_loadu_si256((const __m256i*)(_left + i)), b = _mm256_loadu_si256((const __m256i*)(_right + i));
+			__m256i result = OP == BinopOP::ADD ? _mm256_add_epi64(a, b) : _mm256_sub_epi64(a, b);
+			__m256i overflow = OP == BinopOP::ADD ? _mm256_and_si256(_mm256_xor_si256(a, result), _mm256_xor_si256(b, result)) : _mm256_and_si256(_mm256_xor_si256(a, b), _mm256_xor_si256(a, result));
+			_mm256_storeu_si256((__m256i*)(_destination + i), result);
+
+			if (int mask = _mm256_movemask_pd(_mm256_castsi256_pd(overflow)))
+			{
+				FlagOverflows(_status + i, mask);
+				failed = true;
+			}
+		}
+
+		return IntSse2<OP>(_destination + i, _left + i, _right + i, _count - i, _status + i) || failed;
+	}
+
+	template<BinopOP OP>
+	TARGET_AVX2 bool FloatAvx2(uint64_t* _destination, const uint64_t* _left, const uint64_t* _right, size_t _count, uint8_t* _status)
+	{
+		size_t i = 0;
+
+		for (; i + 4 <= _count; i += 4)
+		{
+			__m256d a = _mm256_loadu_pd((const double*)(_left + i)), b = _mm256_loadu_pd((const double*)(_right + i)), result;
+
+			switch (OP)
+			{
+				case BinopOP::ADD: result = _mm256_add_pd(a, b); break;
+				case BinopOP::SUB: result = _mm256_sub_pd(a, b); break;
+				case BinopOP::MUL: result = _mm256_mul_pd(a, b); break;
+				default: result = _mm256_div_pd(a, b); break;
+			}
+
+			_mm256_storeu_pd((double*)(_destination + i), result);
+		}
+
+		return FloatSse2<OP>(_destination + i, _left + i, _right + i, _count - i, _status + i);
+	}
+#pragma endregion
+#endif
+
+	//Indexed by BinopKernel
+	struct BatchKernels
+	{
+		const char* name;
+		Kernel kernels[11];
+	};
+
+	BatchKernels SelectBatchKernels()
+	{
+		BatchKernels result{ "scalar", {
+			InvalidScalar,
+			IntScalar<BinopOP::ADD>, IntScalar<BinopOP::SUB>, IntScalar<BinopOP::MUL>, IntScalar<BinopOP::DIV>, IntScalar<BinopOP::MOD>,
+			FloatScalar<BinopOP::ADD>, FloatScalar<BinopOP::SUB>, FloatScalar<BinopOP::MUL>, FloatScalar<BinopOP::DIV>, FloatScalar<BinopOP::MOD> } };
+
+#ifdef EDE_BATCH_X64
+		bool avx2 = parser::HasAvx2();
+
+		result.name = avx2 ? "avx2" : "sse2";
+		result.kernels[(size_t)BinopKernel::ADD_INT] = avx2 ? IntAvx2<BinopOP::ADD> : IntSse2<BinopOP::ADD>;
+		result.kernels[(size_t)BinopKernel::SUB_INT] = avx2 ? IntAvx2<BinopOP::SUB> : IntSse2<BinopOP::SUB>;
+		result.kernels[(size_t)BinopKernel::ADD_FLOAT] = avx2 ? FloatAvx2<BinopOP::ADD> : FloatSse2<BinopOP::ADD>;
+		result.kernels[(size_t)BinopKernel::SUB_FLOAT] = avx2 ? FloatAvx2<BinopOP::SUB> : FloatSse2<BinopOP::SUB>;
+		result.kernels[(size_t)BinopKernel::MUL_FLOAT] = avx2 ? FloatAvx2<BinopOP::MUL> : FloatSse2<BinopOP::MUL>;
+		result.kernels[(size_t)BinopKernel::DIV_FLOAT] = avx2 ? FloatAvx2<BinopOP::DIV> : FloatSse2<BinopOP::DIV>;
+#endif
+
+		return result;
+	}
+
+	const BatchKernels kernels = SelectBatchKernels();
+
+	const char* GetBatchKernelName() { return kernels.name; }
+
+#pragma region Compiler
+	//Lowers the tree to steps over virtual locations, one per value, then maps those onto as few real
+	//locations as the live ranges allow; the code is straight-line, so a single linear scan does it
+	class Compiler
+	{
+		struct Virtual
+		{
+			Plan::LocationKind kind;
+			uint64_t value;
+			size_t lastUse; //Last step reading it
+			uint32_t location;
+		};
+
+		std::vector<Virtual> virtuals;
+		std::vector<Plan::Step> steps; //Refer to virtuals until Finish
+		std::unordered_map<uint64_t, uint32_t> constants;
+		std::vector<uint32_t> slotVirtuals;
+		std::vector<ValueType> slotTypes;
+		std::vector<Expression*> stack; //Scratch for VisitPostOrder
+		std::vector<uint32_t> operands; //Virtuals of the operands compiled so far
+
+		uint32_t NewVirtual(Plan::LocationKind _kind, uint64_t _value)
+		{
+			virtuals.push_back(Virtual{ _kind, _value, 0, Plan::NO_LOCATION });
+			return (uint32_t)virtuals.size() - 1;
+		}
+
+		uint32_t Constant(uint64_t _bits)
+		{
+			auto result = constants.emplace(_bits, (uint32_t)virtuals.size());
+			if (result.second) { NewVirtual(Plan::LocationKind::CONSTANT, _bits); }
+			return result.first->second;
+		}
+
+		//_type is set after every node, so it ends with the type of _expr
+		uint32_t CompileExpression(Expression* _expr, ValueType& _type)
+		{
+			operands.clear();
+
+			VisitPostOrder(_expr, stack, [&](Expression* _node)
+			{
+				switch (_node->GetID())
+				{
+					case ExprID::LITERAL:
+					{
+						const Value& value = ((Literal*)_node)->GetValue();
+						_type = value.GetType();
+						operands.push_back(Constant(value.GetBits()));
+					} break;
+					case ExprID::IDENTIFIER:
+					{
+						uint32_t slot = ((Identifier*)_node)->GetDecl()->GetSlot();
+						_type = slotTypes[slot];
+						operands.push_back(slotVirtuals[slot] != Plan::NO_LOCATION ? slotVirtuals[slot] : Constant(0));
+					} break;
+					case ExprID::BINOP:
+					{
+						Binop* binop = (Binop*)_node;
+						uint32_t right = operands.back();
+						operands.pop_back();
+						uint32_t left = operands.back();
+						uint32_t destination = NewVirtual(Plan::LocationKind::TEMPORARY, 0);
+
+						virtuals[left].lastUse = virtuals[right].lastUse = virtuals[destination].lastUse = steps.size();
+						steps.push_back(Plan::Step{ binop->GetKernel(), destination, left, right, binop->GetPosition(), binop->GetOP() });
+
+						_type = binop->GetKernel() >= BinopKernel::ADD_FLOAT ? ValueType::FLOAT : ValueType::INT;
+						operands.back() = destination;
+					} break;
+					default:
+					{
+						_type = ValueType::UNIT;
+						operands.push_back(Constant(0));
+					} break;
+				}
+
+				return true;
+			});
+
+			return operands.back();
+		}
+
+		//Returns the virtual holding the value of _stmt, NO_LOCATION if it is UNIT
+		uint32_t CompileStatement(Statement* _stmt, ValueType& _type)
+		{
+			switch (_stmt->GetID())
+			{
+				case StmtID::EXPR: return CompileExpression((Expression*)_stmt, _type);
+				case StmtID::VARDECL:
+				{
+					VarDecl* decl = (VarDecl*)_stmt;
+
+					//A binding is just another name for the value of its initializer
+					slotVirtuals[decl->GetSlot()] = CompileExpression(decl->GetExpr(), slotTypes[decl->GetSlot()]);
+					_type = ValueType::UNIT;
+					return Plan::NO_LOCATION;
+				}
+				case StmtID::BLOCK:
+				{
+					uint32_t value = Plan::NO_LOCATION;
+					_type = ValueType::UNIT;
+
+					for (auto stmt : ((Block*)_stmt)->GetStatements())
+					{
+						if (stmt) { value = CompileStatement(stmt, _type); }
+					}
+
+					return value;
+				}
+			}
+
+			_type = ValueType::UNIT;
+			return Plan::NO_LOCATION;
+		}
+	public:
+		Compiler(uint32_t _frameSize, ArrayView<const ValueType> _inputTypes) : slotVirtuals(_frameSize, Plan::NO_LOCATION), slotTypes(_frameSize, ValueType::UNIT)
+		{
+			for (size_t i = 0; i < _inputTypes.size && i < _frameSize; i++)
+			{
+				slotVirtuals[i] = NewVirtual(Plan::LocationKind::INPUT, i);
+				slotTypes[i] = _inputTypes[i];
+			}
+		}
+
+		Plan Compile(Block* _block)
+		{
+			ValueType type;
+			uint32_t result = CompileStatement(_block, type);
+			if (result != Plan::NO_LOCATION) { virtuals[result].lastUse = SIZE_MAX; }
+
+			std::vector<Plan::Location> locations;
+			std::vector<uint32_t> available;
+
+			for (Virtual& virt : virtuals)
+			{
+				if (virt.kind == Plan::LocationKind::TEMPORARY) { continue; }
+
+				virt.location = (uint32_t)locations.size();
+				locations.push_back(Plan::Location{ virt.kind, virt.value });
+			}
+
+			for (size_t i = 0; i < steps.size(); i++)
+			{
+				Plan::Step& step = steps[i];
+				const Virtual& left = virtuals[step.left], & right = virtuals[step.right];
+				Virtual& destination = virtuals[step.destination];
+
+				step.left = left.location;
+				step.right = right.location;
+
+				//Operands read for the last time may be overwritten by this very step
+				if (left.kind == Plan::LocationKind::TEMPORARY && left.lastUse == i) { available.push_back(left.location); }
+				if (right.kind == Plan::LocationKind::TEMPORARY && right.lastUse == i && step.right != step.left) { available.push_back(right.location); }
+
+				if (available.empty())
+				{
+					available.push_back((uint32_t)locations.size());
+					locations.push_back(Plan::Location{ Plan::LocationKind::TEMPORARY, 0 });
+				}
+
+				destination.location = available.back();
+				available.pop_back();
+				step.destination = destination.location;
+
+				//Values nobody reads are still computed, their errors count
+				if (destination.lastUse == i) { available.push_back(destination.location); }
+			}
+
+			return Plan(std::move(locations), std::move(steps), result == Plan::NO_LOCATION ? result : virtuals[result].location, type);
+		}
+	};
+
+	Plan Compile(Block* _block, uint32_t _frameSize, ArrayView<const ValueType> _inputTypes)
+	{
+		Compiler compiler(_frameSize, _inputTypes);
+		return compiler.Compile(_block);
+	}
+#pragma endregion
+
+#pragma region Evaluator
+	Value Output::GetValue(size_t _row) const
+	{
+		switch (type)
+		{
+			case ValueType::INT: return (INT)values[_row];
+			case ValueType::FLOAT: return LoadFloat(&values[_row]);
+			case ValueType::BOOL: return values[_row] != 0;
+			default: return UNIT();
+		}
+	}
+
+	bool Evaluator::Run(const Plan& _plan, ArrayView<const Column> _inputs, size_t _rows, Output& _output, Diagnostics& _diagnostics)
+	{
+		const std::vector<Plan::Location>& locations = _plan.GetLocations();
+		const std::vector<Plan::Step>& steps = _plan.GetSteps();
+		uint32_t result = _plan.GetResult();
+
+		//INT and FLOAT inputs are read in place, through memcpy and vector loads only; everything else gets a buffer of CHUNK_SIZE lanes
+		auto isBuffered = [&](const Plan::Location& _location) { return _location.kind != Plan::LocationKind::INPUT || _inputs[_location.value].type == ValueType::BOOL; };
+		size_t buffers = std::count_if(locations.begin(), locations.end(), isBuffered);
+
+		memory.resize(buffers * CHUNK_SIZE);
+		pointers.resize(locations.size());
+		status.assign(CHUNK_SIZE, 0);
+		firstStatus.assign(CHUNK_SIZE, 0);
+		firstStep.assign(CHUNK_SIZE, 0);
+
+		for (size_t i = 0, next = 0; i < locations.size(); i++)
+		{
+			if (!isBuffered(locations[i])) { continue; }
+
+			pointers[i] = memory.data() + next++ * CHUNK_SIZE;
+			if (locations[i].kind == Plan::LocationKind::CONSTANT) { std::fill(pointers[i], pointers[i] + CHUNK_SIZE, locations[i].value); }
+		}
+
+		_output.type = _plan.GetResultType();
+		_output.values.resize(_rows);
+		_output.errors.clear();
+
+		for (size_t start = 0; start < _rows; start += CHUNK_SIZE)
+		{
+			size_t count = std::min(CHUNK_SIZE, _rows - start);
+			bool failed = false;
+
+			for (size_t i = 0; i < locations.size() && locations[i].kind == Plan::LocationKind::INPUT; i++)
+			{
+				const Column& column = _inputs[locations[i].value];
+
+				if (column.type != ValueType::BOOL) { pointers[i] = (uint64_t*)column.data + start; }
+				else { std::copy((const BOOL*)column.data + start, (const BOOL*)column.data + start + count, pointers[i]); }
+			}
+
+			for (size_t s = 0; s < steps.size(); s++)
+			{
+				const Plan::Step& step = steps[s];
+				if (!kernels.kernels[(size_t)step.kernel](pointers[step.destination], pointers[step.left], pointers[step.right], count, status.data())) { continue; }
+
+				//Only the first error of a row counts; later steps compute values for it that are never used
+				failed = true;
+
+				for (size_t row = 0; row < count; row++)
+				{
+					if (!status[row]) { continue; }
+
+					if (!firstStep[row])
+					{
+						firstStep[row] = (uint32_t)s + 1;
+						firstStatus[row] = status[row];
+					}
+
+					status[row] = 0;
+				}
+			}
+
+			if (result != Plan::NO_LOCATION) { std::memcpy(&_output.values[start], pointers[result], count * sizeof(uint64_t)); }
+			else { std::fill(&_output.values[start], &_output.values[start] + count, 0); }
+
+			if (!failed) { continue; }
+
+			for (size_t row = 0; row < count; row++)
+			{
+				if (!firstStep[row]) { continue; }
+
+				const Plan::Step& step = steps[firstStep[row] - 1];
+				_output.errors.push_back(RowError{ start + row, (EvalStatus)firstStatus[row], step.position, step.op });
+				firstStep[row] = 0;
+			}
+		}
+
+		for (const RowError& error : _output.errors)
+			_diagnostics.Push(GetStatusDiagnostic(error.status), error.position, GetBinopSymbol(error.op));
+
+		return _output.errors.empty();
+	}
+#pragma endregion
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Interpreter.h"
+
+using namespace ede::interpreter;
+
+namespace ede::batch
+{
+	//The values an input takes in every row of a batch, stored contiguously
+	struct Column
+	{
+		ValueType type;
+		const void* data;
+
+		Column(const INT* _data) : type(ValueType::INT), data(_data) { }
+		Column(const FLOAT* _data) : type(ValueType::FLOAT), data(_data) { }
+		Column(const BOOL* _data) : type(ValueType::BOOL), data(_data) { }
+	};
+
+	//Runtime error of one row, exactly as running that row alone would have reported it
+	struct RowError
+	{
+		size_t row;
+		EvalStatus status;
+		Position position;
+		BinopOP op;
+	};
+
+	struct Output
+	{
+		ValueType type;
+		std::vector<uint64_t> values; //Raw payload of every row; unspecified for rows that failed
+		std::vector<RowError> errors; //Sorted by row
+
+		Value GetValue(size_t _row) const;
+	};
+
+	//A checked block lowered to whole-column operations: one step per Binop, in the order the VM runs them.
+	//Every value lives in a location; inputs are read in place, constants are filled once per run and
+	//temporaries are reused as soon as their last reader has run.
+	class Plan
+	{
+	public:
+		enum class LocationKind : uint8_t { INPUT, CONSTANT, TEMPORARY };
+
+		struct Location
+		{
+			LocationKind kind;
+			uint64_t value; //Input index or constant payload
+		};
+
+		struct Step
+		{
+			BinopKernel kernel;
+			uint32_t destination, left, right; //Locations; the destination may be one of the operands
+			Position position;
+			BinopOP op;
+		};
+
+		static constexpr uint32_t NO_LOCATION = UINT32_MAX;
+	private:
+		std::vector<Location> locations;
+		std::vector<Step> steps;
+		uint32_t result;
+		ValueType resultType;
+	public:
+		Plan(std::vector<Location> _locations, std::vector<Step> _steps, uint32_t _result, ValueType _resultType)
+			: locations(std::move(_locations)), steps(std::move(_steps)), result(_result), resultType(_resultType) { }
+
+		const std::vector<Location>& GetLocations() const { return locations; }
+		const std::vector<Step>& GetSteps() const { return steps; }
+
+		//Location of the program's result, NO_LOCATION if it is UNIT
+		uint32_t GetResult() const { return result; }
+		ValueType GetResultType() const { return resultType; }
+	};
+
+	//Lowers a resolved and checked block whose first slots hold inputs of _inputTypes, see resolver::Resolve.
+	//Like vm::Compile, the program's result is the value of its last statement.
+	Plan Compile(Block* _block, uint32_t _frameSize, ArrayView<const ValueType> _inputTypes);
+
+	//Runs plans over columns, CHUNK_SIZE rows at a time so every location stays in cache. Every row gets the
+	//value and the first runtime error the VM would give it; a failed row reports its diagnostic, in row order.
+	//Holds scratch memory only, so one evaluator per thread can run any number of plans.
+	class Evaluator
+	{
+		std::vector<uint64_t> memory;
+		std::vector<uint64_t*> pointers; //Of every location, for the current chunk
+		std::vector<uint8_t> status, firstStatus;
+		std::vector<uint32_t> firstStep; //Per row of the chunk, one more than the step that failed first
+	public:
+		static constexpr size_t CHUNK_SIZE = 1024;
+
+		//_inputs must have the types _plan was compiled for and hold _rows values each.
+		//Returns false if any row failed.
+		bool Run(const Plan& _plan, ArrayView<const Column> _inputs, size_t _rows, Output& _output, Diagnostics& _diagnostics);
+	};
+
+	//Name of the arithmetic kernels selected at startup: AVX2 or SSE2 where the CPU supports them, scalar
+	//otherwise. Only the operations the instruction set has lanes for are vectorized; INT * / % and FLOAT %
+	//stay scalar. Defining EDE_NO_SIMD forces the scalar kernels.
+	const char* GetBatchKernelName();
+};
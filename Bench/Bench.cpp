@@ -0,0 +1,325 @@
+#include "pch.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Checker.h"
+#include "Interpreter.h"
+#include "Dump.h"
+#include "CharScan.h"
+#include "Corpus.h"
+
+using namespace ede;
+using namespace ede::bench;
+
+//One timed phase on one corpus; the fastest of the repetitions is kept, it is the least disturbed by noise
+struct Measurement
+{
+	std::string corpus, phase;
+	size_t bytes;
+	double seconds;
+
+	double GetThroughput() const { return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0; }
+	bool SameCase(const Measurement& _other) const { return corpus == _other.corpus && phase == _other.phase && bytes == _other.bytes; }
+};
+
+static const char* const PHASES[] = { "tokenize", "parse", "tostring", "dump", "json", "evaluate" };
+
+#pragma region Phases
+template<typename F>
+double Time(size_t _repeat, F _run)
+{
+	double best = INFINITY;
+
+	for (size_t i = 0; i < _repeat; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		_run();
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return best;
+}
+
+//Runs the selected phases over _src. Phases that need a tree get one parsed outside the timing.
+//Returns false if the corpus produced diagnostics, which would make the numbers meaningless.
+bool MeasureCorpus(std::string_view _corpus, std::string_view _src, const std::vector<std::string>& _phases, size_t _repeat, std::vector<Measurement>& _results)
+{
+	Diagnostics diagnostics;
+	auto selected = [&](std::string_view _phase) { return std::find(_phases.begin(), _phases.end(), _phase) != _phases.end(); };
+	auto add = [&](std::string_view _phase, double _seconds) { _results.push_back(Measurement{ std::string(_corpus), std::string(_phase), _src.size(), _seconds }); };
+
+	if (selected("tokenize"))
+		add("tokenize", Time(_repeat, [&]() { parser::Tokenize(_src, 4, diagnostics); }));
+
+	if (selected("parse"))
+		add("parse", Time(_repeat, [&]() { Arena arena; parser::Parse(_src, 4, arena, diagnostics); }));
+
+	if (selected("tostring") || selected("dump") || selected("json") || selected("evaluate"))
+	{
+		Arena arena;
+		Block* block = parser::Parse(_src, 4, arena, diagnostics);
+		std::ostream sink(nullptr); //Discards what the dumps write
+
+		if (selected("tostring"))
+			add("tostring", Time(_repeat, [&]() { StringBuilder builder; block->ToString(builder); }));
+
+		if (selected("dump"))
+			add("dump", Time(_repeat, [&]() { dump::Writer writer(sink); dump::Dump(block, dump::Format::TREE, writer); }));
+
+		if (selected("json"))
+			add("json", Time(_repeat, [&]() { dump::Writer writer(sink); dump::Dump(block, dump::Format::JSON, writer); }));
+
+		if (selected("evaluate"))
+		{
+			uint32_t frameSize = 0;
+			resolver::Resolve(block, frameSize, diagnostics);
+			checker::Check(block, diagnostics);
+
+			add("evaluate", Time(_repeat, [&]() { interpreter::Evaluate(block, frameSize, diagnostics); }));
+		}
+	}
+
+	return diagnostics.GetCount() == 0;
+}
+#pragma endregion
+
+#pragma region JSON
+void WriteJson(std::ostream& _stream, const std::vector<Measurement>& _results)
+{
+	_stream.precision(9);
+	_stream << "{\n\t\"version\": 1,\n\t\"scanKernels\": \"" << parser::GetScanKernelName() << "\",\n\t\"results\": [";
+
+	for (size_t i = 0; i < _results.size(); i++)
+	{
+		const Measurement& result = _results[i];
+		_stream << (i ? ",\n" : "\n") << "\t\t{ \"corpus\": \"" << result.corpus << "\", \"phase\": \"" << result.phase << "\", \"bytes\": " << result.bytes
+			<< ", \"seconds\": " << result.seconds << ", \"mbPerSecond\": " << result.GetThroughput() << " }";
+	}
+
+	_stream << "\n\t]\n}\n";
+}
+
+//Reads the results of a file written by WriteJson. Only the subset of JSON it writes is understood: the objects
+//of the "results" array, with string and number members. Returns false if the file does not look like one.
+bool ReadJson(std::string_view _json, std::vector<Measurement>& _results)
+{
+	size_t cursor = _json.find("\"results\"");
+	if (cursor == std::string_view::npos || (cursor = _json.find('[', cursor)) == std::string_view::npos) { return false; }
+
+	auto skipSpace = [&]() { while (cursor < _json.size() && parser::IsSpace((unsigned char)_json[cursor])) { cursor++; } };
+	auto readString = [&](std::string& _out)
+	{
+		size_t end = _json.find('"', cursor + 1);
+		if (_json[cursor] != '"' || end == std::string_view::npos) { return false; }
+
+		_out = std::string(_json.substr(cursor + 1, end - cursor - 1));
+		cursor = end + 1;
+		return true;
+	};
+
+	for (cursor++;;)
+	{
+		skipSpace();
+		if (cursor < _json.size() && _json[cursor] == ']') { return true; }
+		if (cursor < _json.size() && _json[cursor] == ',') { cursor++; skipSpace(); }
+		if (cursor >= _json.size() || _json[cursor] != '{') { return false; }
+
+		Measurement result{ "", "", 0, 0 };
+		cursor++;
+
+		for (;;)
+		{
+			std::string key, text;
+			skipSpace();
+			if (cursor < _json.size() && _json[cursor] == '}') { cursor++; break; }
+			if (cursor < _json.size() && _json[cursor] == ',') { cursor++; skipSpace(); }
+			if (cursor >= _json.size() || !readString(key)) { return false; }
+
+			skipSpace();
+			if (cursor >= _json.size() || _json[cursor++] != ':') { return false; }
+			skipSpace();
+
+			if (cursor < _json.size() && _json[cursor] == '"')
+			{
+				if (!readString(text)) { return false; }
+				if (key == "corpus") { result.corpus = text; }
+				else if (key == "phase") { result.phase = text; }
+				continue;
+			}
+
+			size_t end = cursor;
+			while (end < _json.size() && (parser::IsDigit((unsigned char)_json[end]) || (_json[end] && std::strchr("+-.eE", _json[end])))) { end++; }
+			if (end == cursor) { return false; }
+
+			double number = std::strtod(std::string(_json.substr(cursor, end - cursor)).c_str(), nullptr);
+			cursor = end;
+
+			if (key == "bytes") { result.bytes = (size_t)number; }
+			else if (key == "seconds") { result.seconds = number; }
+		}
+
+		_results.push_back(result);
+	}
+}
+#pragma endregion
+
+//Prints every case found in both runs and returns the number of cases whose throughput dropped by more than _threshold percent
+size_t Compare(const std::vector<Measurement>& _baseline, const std::vector<Measurement>& _results, double _threshold)
+{
+	size_t regressions = 0;
+
+	for (const Measurement& result : _results)
+	{
+		auto search = std::find_if(_baseline.begin(), _baseline.end(), [&](const Measurement& _base) { return _base.SameCase(result); });
+		if (search == _baseline.end() || search->GetThroughput() <= 0) { continue; }
+
+		double change = (result.GetThroughput() / search->GetThroughput() - 1) * 100;
+		bool regressed = change < -_threshold;
+		if (regressed) { regressions++; }
+
+		std::printf("  %-9s %12zu %-9s %10.1f -> %10.1f MB/s %+7.1f%%%s\n", result.corpus.c_str(), result.bytes, result.phase.c_str(),
+			search->GetThroughput(), result.GetThroughput(), change, regressed ? "  REGRESSION" : "");
+	}
+
+	return regressions;
+}
+
+//Accepts plain byte counts and the suffixes K, M and G (powers of 1024)
+bool ParseSize(std::string_view _text, size_t& _size)
+{
+	size_t multiplier = 1;
+
+	switch (_text.empty() ? 0 : _text.back())
+	{
+		case 'K': case 'k': multiplier = 1024; break;
+		case 'M': case 'm': multiplier = 1024 * 1024; break;
+		case 'G': case 'g': multiplier = 1024 * 1024 * 1024; break;
+		default: break;
+	}
+
+	if (multiplier != 1) { _text.remove_suffix(1); }
+
+	auto result = std::from_chars(_text.data(), _text.data() + _text.size(), _size);
+	_size *= multiplier;
+	return result.ec == std::errc() && result.ptr == _text.data() + _text.size() && _size != 0;
+}
+
+std::vector<std::string> SplitList(std::string_view _list)
+{
+	std::vector<std::string> result;
+
+	for (size_t start = 0; start <= _list.size();)
+	{
+		size_t end = std::min(_list.find(',', start), _list.size());
+		if (end != start) { result.emplace_back(_list.substr(start, end - start)); }
+		start = end + 1;
+	}
+
+	return result;
+}
+
+//Usage: ede_bench [--corpora lets,nested,chains,literals] [--sizes 64K,1M,16M] [--phases tokenize,parse,tostring,dump,json,evaluate]
+//                 [--repeat n] [--json file] [--baseline file] [--threshold percent] [--write-corpus directory]
+//Exits with 1 if a case regressed against the baseline, 2 on bad arguments or files.
+int main(int argc, char** argv)
+{
+	std::vector<std::string> corpora, phases(std::begin(PHASES), std::end(PHASES)), sizes = { "64K", "1M", "16M" };
+	std::string jsonPath, baselinePath, corpusDirectory;
+	size_t repeat = 3;
+	double threshold = 10;
+
+	for (CorpusKind kind : ALL_CORPUS_KINDS)
+		corpora.emplace_back(GetCorpusName(kind));
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--corpora" && hasValue) { corpora = SplitList(argv[++i]); }
+		else if (arg == "--sizes" && hasValue) { sizes = SplitList(argv[++i]); }
+		else if (arg == "--phases" && hasValue) { phases = SplitList(argv[++i]); }
+		else if (arg == "--repeat" && hasValue) { repeat = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10)); }
+		else if (arg == "--json" && hasValue) { jsonPath = argv[++i]; }
+		else if (arg == "--baseline" && hasValue) { baselinePath = argv[++i]; }
+		else if (arg == "--threshold" && hasValue) { threshold = std::strtod(argv[++i], nullptr); }
+		else if (arg == "--write-corpus" && hasValue) { corpusDirectory = argv[++i]; }
+		else
+		{
+			std::cerr << "Unknown argument " << arg << std::endl;
+			return 2;
+		}
+	}
+
+	for (const std::string& phase : phases)
+	{
+		if (std::find(std::begin(PHASES), std::end(PHASES), phase) == std::end(PHASES))
+		{
+			std::cerr << "Unknown phase " << phase << std::endl;
+			return 2;
+		}
+	}
+
+	std::vector<Measurement> baseline, results;
+
+	if (!baselinePath.empty())
+	{
+		std::ifstream file(baselinePath, std::ios::binary);
+		std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		if (!file || !ReadJson(json, baseline))
+		{
+			std::cerr << "Unable to read the baseline " << baselinePath << std::endl;
+			return 2;
+		}
+	}
+
+	std::printf("Scan kernels: %s\n", parser::GetScanKernelName());
+
+	for (const std::string& name : corpora)
+	{
+		CorpusKind kind;
+
+		if (!FindCorpusKind(name, kind))
+		{
+			std::cerr << "Unknown corpus " << name << std::endl;
+			return 2;
+		}
+
+		for (const std::string& sizeText : sizes)
+		{
+			size_t size;
+
+			if (!ParseSize(sizeText, size))
+			{
+				std::cerr << "Invalid size " << sizeText << std::endl;
+				return 2;
+			}
+
+			std::string src = GenerateCorpus(kind, size);
+
+			if (!corpusDirectory.empty())
+				std::ofstream(std::filesystem::path(corpusDirectory) / (name + "-" + sizeText + ".ede"), std::ios::binary) << src;
+
+			size_t first = results.size();
+			if (!MeasureCorpus(name, src, phases, repeat, results))
+				std::printf("  warning: the %s corpus of %s produced diagnostics\n", name.c_str(), sizeText.c_str());
+
+			//The generator overshoots the size by up to one statement, always by the same amount
+			for (size_t i = first; i < results.size(); i++)
+				std::printf("  %-9s %8s %-9s %10.3f ms %10.1f MB/s\n", name.c_str(), sizeText.c_str(), results[i].phase.c_str(), results[i].seconds * 1000, results[i].GetThroughput());
+		}
+	}
+
+	if (!jsonPath.empty())
+	{
+		std::ofstream file(jsonPath, std::ios::binary);
+		WriteJson(file, results);
+	}
+
+	if (baselinePath.empty()) { return 0; }
+
+	std::printf("Against %s (regression above %.1f%%):\n", baselinePath.c_str(), threshold);
+	size_t regressions = Compare(baseline, results, threshold);
+	std::printf("%zu regression%s\n", regressions, regressions == 1 ? "" : "s");
+	return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+#include "pch.h"
+#include "Corpus.h"
+
+namespace ede::bench
+{
+	//SplitMix64; unlike the standard distributions it produces the same sequence with every standard library
+	class Random
+	{
+		uint64_t state;
+	public:
+		Random(uint64_t _seed) : state(_seed) { }
+
+		uint64_t Next()
+		{
+			uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+		//Uniform enough in [_min, _max] for generating text
+		uint64_t Range(uint64_t _min, uint64_t _max) { return _min + Next() % (_max - _min + 1); }
+	};
+
+	std::string_view GetCorpusName(CorpusKind _kind)
+	{
+		switch (_kind)
+		{
+			case CorpusKind::LETS: return "lets";
+			case CorpusKind::NESTED: return "nested";
+			case CorpusKind::CHAINS: return "chains";
+			default: return "literals";
+		}
+	}
+
+	bool FindCorpusKind(std::string_view _name, CorpusKind& _kind)
+	{
+		for (CorpusKind kind : ALL_CORPUS_KINDS)
+		{
+			if (GetCorpusName(kind) != _name) { continue; }
+
+			_kind = kind;
+			return true;
+		}
+
+		return false;
+	}
+
+	//Every generator keeps INT values far from overflow and only divides by non-zero literals, so evaluation
+	//runs to the end
+#pragma region Generators
+	void GenerateLet(std::string& _out, Random& _random, size_t _index, std::vector<std::string>& _ints, std::string& _lastFloat)
+	{
+		std::string name = std::to_string(_index);
+
+		if (_index % 4 == 3)
+		{
+			_out += "let f" + name + ": float = " + (_lastFloat.empty() ? "1.0" : _lastFloat) + " * 0.5 + " + std::to_string(_random.Range(0, 99)) + ".25;\n";
+			_lastFloat = "f" + name;
+			return;
+		}
+
+		//Read one of the last few ints, so bindings are looked up at varying distances
+		std::string source = _ints.empty() ? std::to_string(_random.Range(0, 99)) : _ints[_random.Range(0, _ints.size() - 1)];
+		_out += "let v" + name + ": int = " + source + " + " + std::to_string(_random.Range(0, 99)) + ";\n";
+
+		if (_ints.size() == 16) { _ints.erase(_ints.begin()); }
+		_ints.push_back("v" + name);
+	}
+
+	void GenerateNested(std::string& _out, Random& _random, size_t _index)
+	{
+		size_t depth = (size_t)_random.Range(128, 255);
+		_out += "let n" + std::to_string(_index) + ": int = ";
+
+		if (_index % 2 == 0)
+		{
+			//((((1 + 7) * 2) % 1000) - 3) / 3 ...; the modulo keeps the value bounded, empty operands are random
+			static const char* const OPERATIONS[][2] = { { " + ", "" }, { " * ", "2" }, { " % ", "1000" }, { " - ", "" }, { " / ", "3" } };
+
+			_out.append(depth, '(');
+			_out += '1';
+
+			for (size_t i = 0; i < depth; i++)
+			{
+				const char* const* operation = OPERATIONS[i % 5];
+				_out += operation[0];
+				_out += *operation[1] ? operation[1] : std::to_string(_random.Range(0, 99));
+				_out += ')';
+			}
+		}
+		else
+		{
+			//7 + (3 - (5 + (...)))
+			for (size_t i = 0; i < depth; i++)
+				_out += std::to_string(_random.Range(0, 99)) + (i % 2 ? " - (" : " + (");
+
+			_out += std::to_string(_random.Range(0, 99));
+			_out.append(depth, ')');
+		}
+
+		_out += ";\n";
+	}
+
+	void GenerateChain(std::string& _out, Random& _random, size_t _index)
+	{
+		size_t terms = (size_t)_random.Range(256, 1023);
+		bool isFloat = _index % 3 == 2;
+
+		_out += (isFloat ? "let g" : "let c") + std::to_string(_index) + (isFloat ? ": float = 1.5" : ": int = 1");
+
+		for (size_t i = 0; i < terms; i++)
+		{
+			_out += _random.Range(0, 1) ? " + " : " - ";
+
+			if (isFloat)
+			{
+				static const char* const FACTORS[] = { " * ", " / " };
+				_out += std::to_string(_random.Range(1, 99)) + ".5";
+				if (_random.Range(0, 2) == 0) { _out += FACTORS[_random.Range(0, 1)] + std::to_string(_random.Range(1, 99)) + ".25"; }
+				continue;
+			}
+
+			//Products and quotients of two small literals, so * / % bind tighter than the surrounding + -
+			static const char* const FACTORS[] = { " * ", " / ", " % " };
+			_out += std::to_string(_random.Range(0, 99));
+			if (_random.Range(0, 2) == 0) { _out += FACTORS[_random.Range(0, 2)] + std::to_string(_random.Range(1, 99)); }
+		}
+
+		_out += ";\n";
+	}
+
+	std::string Digits(Random& _random, size_t _count)
+	{
+		std::string result(1, (char)('1' + _random.Range(0, 8)));
+
+		for (size_t i = 1; i < _count; i++)
+			result += (char)('0' + _random.Range(0, 9));
+
+		return result;
+	}
+
+	void GenerateLiterals(std::string& _out, Random& _random, size_t _index)
+	{
+		size_t count = (size_t)_random.Range(4, 8);
+		bool isFloat = _index % 2 == 1;
+
+		_out += (isFloat ? "let g" : "let l") + std::to_string(_index) + (isFloat ? ": float = " : ": int = ");
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if (i != 0) { _out += _random.Range(0, 1) ? " + " : " - "; }
+
+			//At most eight ten-digit INTs, so the sum stays far below 2^63
+			if (isFloat) { _out += Digits(_random, (size_t)_random.Range(1, 8)) + "." + Digits(_random, (size_t)_random.Range(1, 12)); }
+			else { _out += Digits(_random, (size_t)_random.Range(1, 10)); }
+		}
+
+		_out += ";\n";
+	}
+#pragma endregion
+
+	std::string GenerateCorpus(CorpusKind _kind, size_t _size, uint64_t _seed)
+	{
+		Random random(_seed * 4 + (uint64_t)_kind);
+		std::vector<std::string> ints;
+		std::string lastFloat, result;
+
+		result.reserve(_size + 16 * 1024);
+
+		for (size_t i = 0; result.size() < _size; i++)
+		{
+			switch (_kind)
+			{
+				case CorpusKind::LETS: GenerateLet(result, random, i, ints, lastFloat); break;
+				case CorpusKind::NESTED: GenerateNested(result, random, i); break;
+				case CorpusKind::CHAINS: GenerateChain(result, random, i); break;
+				case CorpusKind::LITERALS: GenerateLiterals(result, random, i); break;
+			}
+		}
+
+		return result;
+	}
+};
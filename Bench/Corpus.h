@@ -0,0 +1,22 @@
+#pragma once
+
+namespace ede::bench
+{
+	enum class CorpusKind
+	{
+		LETS, //Long lists of let bindings, each reading an earlier one
+		NESTED, //Expressions nested hundreds of parentheses deep
+		CHAINS, //Long flat chains of binary operators, mixing precedences
+		LITERALS, //Mostly long integer and float literals
+	};
+
+	static const CorpusKind ALL_CORPUS_KINDS[] = { CorpusKind::LETS, CorpusKind::NESTED, CorpusKind::CHAINS, CorpusKind::LITERALS };
+
+	//Name used on the command line and in results
+	std::string_view GetCorpusName(CorpusKind _kind);
+	bool FindCorpusKind(std::string_view _name, CorpusKind& _kind);
+
+	//Generates a program of at least _size bytes that parses, resolves, checks and evaluates without diagnostics.
+	//The text depends only on the arguments, so every build measures exactly the same input.
+	std::string GenerateCorpus(CorpusKind _kind, size_t _size, uint64_t _seed = 1);
+};
@@ -0,0 +1,266 @@
+#include "pch.h"
+#include "Bytecode.h"
+
+namespace ede::vm
+{
+#pragma region Chunk
+	uint32_t Chunk::AddConstant(const Result& _value)
+	{
+		constants.push_back(_value);
+		return (uint32_t)constants.size() - 1;
+	}
+
+	std::string Chunk::ToString() const
+	{
+		std::string result;
+
+		for (size_t i = 0; i < code.size(); i++)
+		{
+			const Instruction& instr = code[i];
+			result += std::to_string(i) + ": ";
+
+			switch (instr.op)
+			{
+				case OpCode::PUSH_CONST: result += "PUSH_CONST " + constants[instr.operand].ToString(); break;
+				case OpCode::ADD: result += "ADD"; break;
+				case OpCode::SUB: result += "SUB"; break;
+				case OpCode::MUL: result += "MUL"; break;
+				case OpCode::DIV: result += "DIV"; break;
+				case OpCode::MOD: result += "MOD"; break;
+				case OpCode::ADD_INT: result += "ADD_INT"; break;
+				case OpCode::SUB_INT: result += "SUB_INT"; break;
+				case OpCode::MUL_INT: result += "MUL_INT"; break;
+				case OpCode::DIV_INT: result += "DIV_INT"; break;
+				case OpCode::MOD_INT: result += "MOD_INT"; break;
+				case OpCode::ADD_FLOAT: result += "ADD_FLOAT"; break;
+				case OpCode::SUB_FLOAT: result += "SUB_FLOAT"; break;
+				case OpCode::MUL_FLOAT: result += "MUL_FLOAT"; break;
+				case OpCode::DIV_FLOAT: result += "DIV_FLOAT"; break;
+				case OpCode::MOD_FLOAT: result += "MOD_FLOAT"; break;
+				case OpCode::LOAD: result += "LOAD " + std::to_string(instr.operand); break;
+				case OpCode::STORE: result += "STORE " + std::to_string(instr.operand); break;
+				case OpCode::POP: result += "POP"; break;
+				case OpCode::RETURN: result += "RETURN"; break;
+			}
+
+			result += '\n';
+		}
+
+		return result;
+	}
+#pragma endregion
+
+#pragma region Compiler
+	OpCode GetBinopOpCode(Binop* _binop)
+	{
+		switch (_binop->GetKernel())
+		{
+			case BinopKernel::ADD_INT: return OpCode::ADD_INT;
+			case BinopKernel::SUB_INT: return OpCode::SUB_INT;
+			case BinopKernel::MUL_INT: return OpCode::MUL_INT;
+			case BinopKernel::DIV_INT: return OpCode::DIV_INT;
+			case BinopKernel::MOD_INT: return OpCode::MOD_INT;
+			case BinopKernel::ADD_FLOAT: return OpCode::ADD_FLOAT;
+			case BinopKernel::SUB_FLOAT: return OpCode::SUB_FLOAT;
+			case BinopKernel::MUL_FLOAT: return OpCode::MUL_FLOAT;
+			case BinopKernel::DIV_FLOAT: return OpCode::DIV_FLOAT;
+			case BinopKernel::MOD_FLOAT: return OpCode::MOD_FLOAT;
+			default: break;
+		}
+
+		switch (_binop->GetOP())
+		{
+			case BinopOP::ADD: return OpCode::ADD;
+			case BinopOP::SUB: return OpCode::SUB;
+			case BinopOP::MUL: return OpCode::MUL;
+			case BinopOP::DIV: return OpCode::DIV;
+			default: return OpCode::MOD;
+		}
+	}
+
+	BinopOP GetOpCodeBinop(OpCode _op)
+	{
+		switch (_op)
+		{
+			case OpCode::ADD: case OpCode::ADD_INT: case OpCode::ADD_FLOAT: return BinopOP::ADD;
+			case OpCode::SUB: case OpCode::SUB_INT: case OpCode::SUB_FLOAT: return BinopOP::SUB;
+			case OpCode::MUL: case OpCode::MUL_INT: case OpCode::MUL_FLOAT: return BinopOP::MUL;
+			case OpCode::DIV: case OpCode::DIV_INT: case OpCode::DIV_FLOAT: return BinopOP::DIV;
+			default: return BinopOP::MOD;
+		}
+	}
+
+	//Scratch of the expression compiler, shared by every expression of a chunk
+	struct Scratch
+	{
+		std::vector<Expression*> stack; //For VisitPostOrder
+		std::vector<size_t> depths; //Stack depth needed by each operand compiled so far
+	};
+
+	//Emits code that leaves the value of _expr on top of the stack and returns the stack depth it needs
+	size_t CompileExpression(Chunk& _chunk, Expression* _expr, Scratch& _scratch)
+	{
+		_scratch.depths.clear();
+
+		VisitPostOrder(_expr, _scratch.stack, [&](Expression* _node)
+		{
+			switch (_node->GetID())
+			{
+				case ExprID::LITERAL: _chunk.Emit(OpCode::PUSH_CONST, _chunk.AddConstant(((Literal*)_node)->GetValue()), _node->GetPosition()); break;
+				case ExprID::IDENTIFIER: _chunk.Emit(OpCode::LOAD, ((Identifier*)_node)->GetDecl()->GetSlot(), _node->GetPosition()); break;
+				case ExprID::BINOP:
+				{
+					size_t rightDepth = _scratch.depths.back();
+					_scratch.depths.pop_back();
+
+					_chunk.Emit(GetBinopOpCode((Binop*)_node), 0, _node->GetPosition());
+					_scratch.depths.back() = std::max(_scratch.depths.back(), rightDepth + 1);
+					return true;
+				}
+				default: _chunk.Emit(OpCode::PUSH_CONST, _chunk.AddConstant(UNIT()), _node->GetPosition()); break;
+			}
+
+			_scratch.depths.push_back(1);
+			return true;
+		});
+
+		return _scratch.depths.back();
+	}
+
+	size_t CompileBlock(Chunk& _chunk, Block* _block, Scratch& _scratch);
+
+	//Emits code for _stmt; if _keepValue is set its value is left on top of the stack, otherwise nothing is
+	size_t CompileStatement(Chunk& _chunk, Statement* _stmt, bool _keepValue, Scratch& _scratch)
+	{
+		size_t depth = 0;
+
+		switch (_stmt->GetID())
+		{
+			case StmtID::EXPR: depth = CompileExpression(_chunk, (Expression*)_stmt, _scratch); break;
+			case StmtID::BLOCK: depth = CompileBlock(_chunk, (Block*)_stmt, _scratch); break;
+			case StmtID::VARDECL:
+			{
+				VarDecl* decl = (VarDecl*)_stmt;
+				depth = CompileExpression(_chunk, decl->GetExpr(), _scratch);
+				_chunk.Emit(OpCode::STORE, decl->GetSlot(), _stmt->GetPosition());
+
+				if (_keepValue)
+					_chunk.Emit(OpCode::PUSH_CONST, _chunk.AddConstant(UNIT()), _stmt->GetPosition());
+
+				return depth;
+			}
+		}
+
+		if (!_keepValue)
+			_chunk.Emit(OpCode::POP, 0, _stmt->GetPosition());
+
+		return depth;
+	}
+
+	//Emits code that leaves the value of the block's last statement on top of the stack
+	size_t CompileBlock(Chunk& _chunk, Block* _block, Scratch& _scratch)
+	{
+		auto statements = _block->GetStatements();
+		size_t last = statements.size, maxDepth = 1;
+
+		while (last != 0 && !statements[last - 1])
+			last--;
+
+		for (size_t i = 0; i < last; i++)
+		{
+			if (statements[i])
+				maxDepth = std::max(maxDepth, CompileStatement(_chunk, statements[i], i + 1 == last, _scratch));
+		}
+
+		//An empty block yields UNIT
+		if (last == 0)
+			_chunk.Emit(OpCode::PUSH_CONST, _chunk.AddConstant(UNIT()), _block->GetPosition());
+
+		return maxDepth;
+	}
+
+	Chunk Compile(Block* _block, uint32_t _frameSize)
+	{
+		Chunk chunk(_frameSize);
+		Scratch scratch;
+
+		chunk.SetMaxStackDepth(CompileBlock(chunk, _block, scratch));
+		chunk.Emit(OpCode::RETURN, 0, _block->GetPosition());
+		return chunk;
+	}
+#pragma endregion
+
+#pragma region VM
+	bool VM::Run(const Chunk& _chunk, Result& _result, Diagnostics& _diagnostics, ArrayView<const Result> _inputs)
+	{
+		stack.resize(_chunk.GetMaxStackDepth());
+		slots.assign(_chunk.GetFrameSize(), UNIT());
+		std::copy(_inputs.begin(), _inputs.begin() + std::min<size_t>(_inputs.size, slots.size()), slots.begin());
+
+		const Instruction* code = _chunk.GetCode().data();
+		const Result* constants = _chunk.GetConstants().data();
+		Result* sp = stack.data();
+		EvalStatus status;
+		INT i;
+
+		for (const Instruction* ip = code;; ip++)
+		{
+			switch (ip->op)
+			{
+				case OpCode::PUSH_CONST: *sp++ = constants[ip->operand]; continue;
+				case OpCode::ADD: sp--; status = EvaluateBinop(BinopOP::ADD, sp[-1], sp[0], sp[-1]); break;
+				case OpCode::SUB: sp--; status = EvaluateBinop(BinopOP::SUB, sp[-1], sp[0], sp[-1]); break;
+				case OpCode::MUL: sp--; status = EvaluateBinop(BinopOP::MUL, sp[-1], sp[0], sp[-1]); break;
+				case OpCode::DIV: sp--; status = EvaluateBinop(BinopOP::DIV, sp[-1], sp[0], sp[-1]); break;
+				case OpCode::MOD: sp--; status = EvaluateBinop(BinopOP::MOD, sp[-1], sp[0], sp[-1]); break;
+				case OpCode::ADD_INT:
+				{
+					sp--;
+					if (!CheckedAdd(sp[-1].AsInt(), sp[0].AsInt(), i)) { status = EvalStatus::INTEGER_OVERFLOW; break; }
+					sp[-1] = i;
+				} continue;
+				case OpCode::SUB_INT:
+				{
+					sp--;
+					if (!CheckedSub(sp[-1].AsInt(), sp[0].AsInt(), i)) { status = EvalStatus::INTEGER_OVERFLOW; break; }
+					sp[-1] = i;
+				} continue;
+				case OpCode::MUL_INT:
+				{
+					sp--;
+					if (!CheckedMul(sp[-1].AsInt(), sp[0].AsInt(), i)) { status = EvalStatus::INTEGER_OVERFLOW; break; }
+					sp[-1] = i;
+				} continue;
+				case OpCode::DIV_INT:
+				case OpCode::MOD_INT:
+				{
+					sp--;
+					status = IntBinop(ip->op == OpCode::DIV_INT ? BinopOP::DIV : BinopOP::MOD, sp[-1].AsInt(), sp[0].AsInt(), i);
+					if (status == EvalStatus::OK) { sp[-1] = i; }
+				} break;
+				case OpCode::ADD_FLOAT: sp--; sp[-1] = sp[-1].AsFloat() + sp[0].AsFloat(); continue;
+				case OpCode::SUB_FLOAT: sp--; sp[-1] = sp[-1].AsFloat() - sp[0].AsFloat(); continue;
+				case OpCode::MUL_FLOAT: sp--; sp[-1] = sp[-1].AsFloat() * sp[0].AsFloat(); continue;
+				case OpCode::DIV_FLOAT: sp--; sp[-1] = sp[-1].AsFloat() / sp[0].AsFloat(); continue;
+				case OpCode::MOD_FLOAT: sp--; sp[-1] = std::fmod(sp[-1].AsFloat(), sp[0].AsFloat()); continue;
+				case OpCode::LOAD: *sp++ = slots[ip->operand]; continue;
+				case OpCode::STORE: slots[ip->operand] = *--sp; continue;
+				case OpCode::POP: sp--; continue;
+				case OpCode::RETURN:
+				{
+					_result = *--sp;
+					return true;
+				}
+			}
+
+			if (status != EvalStatus::OK)
+			{
+				size_t index = ip - code;
+				_diagnostics.Push(GetStatusDiagnostic(status), _chunk.GetPosition(index), GetBinopSymbol(GetOpCodeBinop(ip->op)));
+				_result = UNIT();
+				return false;
+			}
+		}
+	}
+#pragma endregion
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Interpreter.h"
+
+using namespace ede::interpreter;
+
+namespace ede::vm
+{
+	enum class OpCode : uint8_t
+	{
+		PUSH_CONST,		//Pushes constants[operand]
+		ADD, SUB, MUL, DIV, MOD,	//Dynamically typed arithmetic, used for unchecked Binops
+		ADD_INT, SUB_INT, MUL_INT, DIV_INT, MOD_INT,	//Typed arithmetic selected by the checker
+		ADD_FLOAT, SUB_FLOAT, MUL_FLOAT, DIV_FLOAT, MOD_FLOAT,
+		LOAD,			//Pushes slots[operand]
+		STORE,			//Pops into slots[operand]
+		POP,			//Discards the top of the stack
+		RETURN,			//Pops the program's result and stops
+	};
+
+	struct Instruction
+	{
+		OpCode op;
+		uint32_t operand;
+	};
+
+	//A compiled program: a linear instruction list plus the tables it refers to
+	class Chunk
+	{
+		std::vector<Instruction> code;
+		std::vector<Position> positions; //Source position of each instruction, for runtime errors
+		std::vector<Result> constants;
+		uint32_t frameSize;
+		size_t maxStackDepth;
+	public:
+		Chunk(uint32_t _frameSize) : frameSize(_frameSize), maxStackDepth(0) { }
+
+		void Emit(OpCode _op, uint32_t _operand, Position _pos)
+		{
+			code.push_back(Instruction{ _op, _operand });
+			positions.push_back(_pos);
+		}
+
+		uint32_t AddConstant(const Result& _value);
+		void SetMaxStackDepth(size_t _depth) { maxStackDepth = _depth; }
+
+		const std::vector<Instruction>& GetCode() const { return code; }
+		Position GetPosition(size_t _index) const { return positions[_index]; }
+		const std::vector<Result>& GetConstants() const { return constants; }
+		uint32_t GetFrameSize() const { return frameSize; }
+		size_t GetMaxStackDepth() const { return maxStackDepth; }
+
+		std::string ToString() const;
+	};
+
+	//Compiles a resolved block whose bindings fit in a frame of _frameSize slots.
+	//Binops annotated by the checker compile to typed instructions that never inspect operand tags.
+	//The program's result is the value of the last statement, or UNIT if that is a let.
+	Chunk Compile(Block* _block, uint32_t _frameSize);
+
+	class VM
+	{
+		std::vector<Result> stack, slots;
+	public:
+		//Runs _chunk to completion, reporting the first runtime error as a diagnostic.
+		//The first slots of the frame start out as _inputs, the others as UNIT.
+		bool Run(const Chunk& _chunk, Result& _result, Diagnostics& _diagnostics, ArrayView<const Result> _inputs = ArrayView<const Result>());
+
+		const Result& GetSlot(size_t _index) const { return slots[_index]; }
+	};
+};
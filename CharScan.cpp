@@ -0,0 +1,267 @@
+#include "pch.h"
+#include "CharScan.h"
+
+#if !defined(EDE_NO_SIMD) && (defined(_M_X64) || defined(__x86_64__))
+#define EDE_SCAN_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace ede::parser
+{
+#pragma region Scalar
+	WhitespaceRun ScanWhitespaceScalar(WhitespaceRun _run, const char* _cursor, const char* _end)
+	{
+		for (; _cursor != _end && IsSpace((unsigned char)*_cursor); _cursor++)
+		{
+			if (*_cursor == '\n')
+			{
+				_run.newlines++;
+				_run.lineStart = _cursor + 1;
+				_run.tabs = 0;
+			}
+			else if (*_cursor == '\t') { _run.tabs++; }
+		}
+
+		_run.end = _cursor;
+		return _run;
+	}
+
+	WhitespaceRun ScanWhitespaceScalar(const char* _begin, const char* _end) { return ScanWhitespaceScalar(WhitespaceRun{ _begin, 0, nullptr, 0 }, _begin, _end); }
+
+	const char* ScanIdentifierScalar(const char* _begin, const char* _end)
+	{
+		while (_begin != _end && IsIdentifierChar((unsigned char)*_begin))
+			_begin++;
+
+		return _begin;
+	}
+
+	const char* ScanDigitsScalar(const char* _begin, const char* _end)
+	{
+		while (_begin != _end && IsDigit((unsigned char)*_begin))
+			_begin++;
+
+		return _begin;
+	}
+#pragma endregion
+
+#ifdef EDE_SCAN_X64
+#pragma region Masks
+	inline unsigned LowestBit(uint32_t _mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, _mask);
+		return index;
+#else
+		return __builtin_ctz(_mask);
+#endif
+	}
+
+	inline unsigned HighestBit(uint32_t _mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse(&index, _mask);
+		return index;
+#else
+		return 31 - __builtin_clz(_mask);
+#endif
+	}
+
+	inline size_t PopCount(uint32_t _mask)
+	{
+#ifdef _MSC_VER
+		_mask = _mask - ((_mask >> 1) & 0x55555555);
+		_mask = (_mask & 0x33333333) + ((_mask >> 2) & 0x33333333);
+		return (((_mask + (_mask >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#else
+		return __builtin_popcount(_mask);
+#endif
+	}
+
+	//Folds the newline and tab masks of one block into _run; _stop has a bit set for every byte that is
+	//not whitespace. Returns true if the run ends inside the block.
+	inline bool AccumulateWhitespace(WhitespaceRun& _run, const char* _block, uint32_t _stop, uint32_t _newlines, uint32_t _tabs)
+	{
+		if (_stop)
+		{
+			uint32_t valid = (uint32_t)(((uint64_t)1 << LowestBit(_stop)) - 1);
+			_newlines &= valid;
+			_tabs &= valid;
+		}
+
+		if (_newlines)
+		{
+			unsigned last = HighestBit(_newlines);
+			_run.newlines += PopCount(_newlines);
+			_run.lineStart = _block + last + 1;
+			_run.tabs = PopCount(_tabs >> last); //The newline's own bit is never a tab
+		}
+		else { _run.tabs += PopCount(_tabs); }
+
+		if (!_stop) { return false; }
+
+		_run.end = _block + LowestBit(_stop);
+		return true;
+	}
+#pragma endregion
+
+#pragma region SSE2
+	//Bytes in [_first, _first + _count) as a signed compare; bytes >= 0x80 never fall in a range below 0x80
+	inline __m128i InRange(__m128i _bytes, char _first, char _count)
+	{
+		__m128i offset = _mm_sub_epi8(_bytes, _mm_set1_epi8(_first));
+		return _mm_and_si128(_mm_cmpgt_epi8(offset, _mm_set1_epi8(-1)), _mm_cmplt_epi8(offset, _mm_set1_epi8(_count)));
+	}
+
+	WhitespaceRun ScanWhitespaceSse2(WhitespaceRun _run, const char* _cursor, const char* _end)
+	{
+		for (; _end - _cursor >= 16; _cursor += 16)
+		{
+			__m128i bytes = _mm_loadu_si128((const __m128i*)_cursor);
+			__m128i space = _mm_or_si128(InRange(bytes, '\t', 5), _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')));
+			uint32_t stop = ~(uint32_t)_mm_movemask_epi8(space) & 0xFFFF;
+			uint32_t newlines = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+			uint32_t tabs = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t')));
+
+			if (AccumulateWhitespace(_run, _cursor, stop, newlines, tabs))
+				return _run;
+		}
+
+		return ScanWhitespaceScalar(_run, _cursor, _end);
+	}
+
+	WhitespaceRun ScanWhitespaceSse2(const char* _begin, const char* _end) { return ScanWhitespaceSse2(WhitespaceRun{ _begin, 0, nullptr, 0 }, _begin, _end); }
+
+	const char* ScanIdentifierSse2(const char* _begin, const char* _end)
+	{
+		for (; _end - _begin >= 16; _begin += 16)
+		{
+			__m128i bytes = _mm_loadu_si128((const __m128i*)_begin);
+			__m128i letters = InRange(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), 'a', 26);
+			__m128i chars = _mm_or_si128(_mm_or_si128(letters, InRange(bytes, '0', 10)), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_')));
+			uint32_t stop = ~(uint32_t)_mm_movemask_epi8(chars) & 0xFFFF;
+
+			if (stop) { return _begin + LowestBit(stop); }
+		}
+
+		return ScanIdentifierScalar(_begin, _end);
+	}
+
+	const char* ScanDigitsSse2(const char* _begin, const char* _end)
+	{
+		for (; _end - _begin >= 16; _begin += 16)
+		{
+			uint32_t stop = ~(uint32_t)_mm_movemask_epi8(InRange(_mm_loadu_si128((const __m128i*)_begin), '0', 10)) & 0xFFFF;
+			if (stop) { return _begin + LowestBit(stop); }
+		}
+
+		return ScanDigitsScalar(_begin, _end);
+	}
+#pragma endregion
+
+#pragma region AVX2
+	TARGET_AVX2 inline __m256i InRange(__m256i _bytes, char _first, char _count)
+	{
+		__m256i offset = _mm256_sub_epi8(_bytes, _mm256_set1_epi8(_first));
+		return _mm256_andnot_si256(_mm256_cmpgt_epi8(_mm256_setzero_si256(), offset), _mm256_cmpgt_epi8(_mm256_set1_epi8(_count), offset));
+	}
+
+	TARGET_AVX2 WhitespaceRun ScanWhitespaceAvx2(const char* _begin, const char* _end)
+	{
+		WhitespaceRun run{ _begin, 0, nullptr, 0 };
+		const char* cursor = _begin;
+
+		for (; _end - cursor >= 32; cursor += 32)
+		{
+			__m256i bytes = _mm256_loadu_si256((const __m256i*)cursor);
+			__m256i space = _mm256_or_si256(InRange(bytes, '\t', 5), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')));
+			uint32_t stop = ~(uint32_t)_mm256_movemask_epi8(space);
+			uint32_t newlines = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')));
+			uint32_t tabs = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t')));
+
+			if (AccumulateWhitespace(run, cursor, stop, newlines, tabs))
+				return run;
+		}
+
+		return ScanWhitespaceSse2(run, cursor, _end);
+	}
+
+	TARGET_AVX2 const char* ScanIdentifierAvx2(const char* _begin, const char* _end)
+	{
+		for (; _end - _begin >= 32; _begin += 32)
+		{
+			__m256i bytes = _mm256_loadu_si256((const __m256i*)_begin);
+			__m256i letters = InRange(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), 'a', 26);
+			__m256i chars = _mm256_or_si256(_mm256_or_si256(letters, InRange(bytes, '0', 10)), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_')));
+			uint32_t stop = ~(uint32_t)_mm256_movemask_epi8(chars);
+
+			if (stop) { return _begin + LowestBit(stop); }
+		}
+
+		return ScanIdentifierSse2(_begin, _end);
+	}
+
+	TARGET_AVX2 const char* ScanDigitsAvx2(const char* _begin, const char* _end)
+	{
+		for (; _end - _begin >= 32; _begin += 32)
+		{
+			uint32_t stop = ~(uint32_t)_mm256_movemask_epi8(InRange(_mm256_loadu_si256((const __m256i*)_begin), '0', 10));
+			if (stop) { return _begin + LowestBit(stop); }
+		}
+
+		return ScanDigitsSse2(_begin, _end);
+	}
+#pragma endregion
+#endif
+
+	bool HasAvx2()
+	{
+#ifndef EDE_SCAN_X64
+		return false;
+#elif defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) { return false; } //The OS must preserve the YMM registers
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	struct ScanKernels
+	{
+		const char* name;
+		WhitespaceRun(*whitespace)(const char*, const char*);
+		const char* (*identifier)(const char*, const char*);
+		const char* (*digits)(const char*, const char*);
+	};
+
+	ScanKernels SelectScanKernels()
+	{
+#ifdef EDE_SCAN_X64
+		if (HasAvx2()) { return ScanKernels{ "avx2", ScanWhitespaceAvx2, ScanIdentifierAvx2, ScanDigitsAvx2 }; }
+		else { return ScanKernels{ "sse2", ScanWhitespaceSse2, ScanIdentifierSse2, ScanDigitsSse2 }; }
+#else
+		return ScanKernels{ "scalar", ScanWhitespaceScalar, ScanIdentifierScalar, ScanDigitsScalar };
+#endif
+	}
+
+	const ScanKernels kernels = SelectScanKernels();
+
+	WhitespaceRun ScanWhitespace(const char* _begin, const char* _end) { return kernels.whitespace(_begin, _end); }
+	const char* ScanIdentifier(const char* _begin, const char* _end) { return kernels.identifier(_begin, _end); }
+	const char* ScanDigits(const char* _begin, const char* _end) { return kernels.digits(_begin, _end); }
+	const char* GetScanKernelName() { return kernels.name; }
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+namespace ede::parser
+{
+	//Locale independent character classes; the source is treated as raw bytes
+	inline bool IsSpace(int _c) { return _c == ' ' || (_c >= '\t' && _c <= '\r'); }
+	inline bool IsDigit(int _c) { return _c >= '0' && _c <= '9'; }
+	inline bool IsAlpha(int _c) { return (_c >= 'a' && _c <= 'z') || (_c >= 'A' && _c <= 'Z'); }
+	inline bool IsIdentifierChar(int _c) { return IsAlpha(_c) || IsDigit(_c) || _c == '_'; }
+
+	//Summary of a run of whitespace, enough to advance a source position without revisiting the bytes
+	struct WhitespaceRun
+	{
+		const char* end;
+		size_t newlines;
+		const char* lineStart; //Byte after the last newline in the run, nullptr if there is none
+		size_t tabs; //Tabs after lineStart, or in the whole run if it has no newline
+	};
+
+	//Scanners for the runs the lexer consumes; each returns the end of the longest run starting at _begin.
+	//The implementation is picked once at startup: AVX2 or SSE2 where the CPU supports it, scalar otherwise.
+	//Defining EDE_NO_SIMD forces the scalar implementation.
+	WhitespaceRun ScanWhitespace(const char* _begin, const char* _end);
+	const char* ScanIdentifier(const char* _begin, const char* _end);
+	const char* ScanDigits(const char* _begin, const char* _end);
+
+	//Name of the selected implementation
+	const char* GetScanKernelName();
+
+	//True if both the CPU and the OS support AVX2; always false when EDE_NO_SIMD is defined or off x86-64
+	bool HasAvx2();
+};
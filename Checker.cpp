@@ -0,0 +1,120 @@
+#include "pch.h"
+#include "Checker.h"
+
+namespace ede::checker
+{
+	BinopKernel SelectKernel(BinopOP _op, Type* _left, Type* _right)
+	{
+		static const BinopKernel INT_KERNELS[] = { BinopKernel::ADD_INT, BinopKernel::SUB_INT, BinopKernel::MUL_INT, BinopKernel::DIV_INT, BinopKernel::MOD_INT };
+		static const BinopKernel FLOAT_KERNELS[] = { BinopKernel::ADD_FLOAT, BinopKernel::SUB_FLOAT, BinopKernel::MUL_FLOAT, BinopKernel::DIV_FLOAT, BinopKernel::MOD_FLOAT };
+
+		if (_left != _right) { return BinopKernel::NONE; }
+		else if (_left == GetPrimitiveType(PrimitiveID::INT)) { return INT_KERNELS[(size_t)_op]; }
+		else if (_left == GetPrimitiveType(PrimitiveID::FLOAT)) { return FLOAT_KERNELS[(size_t)_op]; }
+		else { return BinopKernel::NONE; }
+	}
+
+	Type* GetValueType(const Value& _value)
+	{
+		switch (_value.GetType())
+		{
+			case ValueType::INT: return GetPrimitiveType(PrimitiveID::INT);
+			case ValueType::FLOAT: return GetPrimitiveType(PrimitiveID::FLOAT);
+			case ValueType::BOOL: return GetPrimitiveType(PrimitiveID::BOOL);
+			default: return GetPrimitiveType(PrimitiveID::UNIT);
+		}
+	}
+
+	Type* CheckBinop(Binop* _binop, Diagnostics& _diagnostics)
+	{
+		Type* left = _binop->GetLeft()->GetType();
+		Type* right = _binop->GetRight()->GetType();
+
+		if (!left || !right) { return nullptr; }
+
+		BinopKernel kernel = SelectKernel(_binop->GetOP(), left, right);
+		_binop->SetKernel(kernel);
+
+		if (kernel != BinopKernel::NONE) { return left; }
+
+		_diagnostics.Push(DiagnosticType::ERROR_InvalidOperands, _binop->GetPosition(), left->GetName(), GetBinopSymbol(_binop->GetOP()), right->GetName());
+		return nullptr;
+	}
+
+	//Returns the inferred type, or nullptr if the expression is ill-typed (the error has been reported).
+	//Operands are checked first, so a Binop finds their types already set.
+	Type* CheckExpression(Expression* _expr, std::vector<Expression*>& _stack, Diagnostics& _diagnostics)
+	{
+		VisitPostOrder(_expr, _stack, [&](Expression* _node)
+		{
+			Type* type = nullptr;
+
+			switch (_node->GetID())
+			{
+				case ExprID::LITERAL: type = GetValueType(((Literal*)_node)->GetValue()); break;
+				case ExprID::IDENTIFIER:
+				{
+					//Unresolved identifiers have already been reported by the resolver
+					VarDecl* decl = ((Identifier*)_node)->GetDecl();
+					type = decl ? decl->GetType() : nullptr;
+				} break;
+				case ExprID::BINOP: type = CheckBinop((Binop*)_node, _diagnostics); break;
+			}
+
+			_node->SetType(type);
+			return true;
+		});
+
+		return _expr->GetType();
+	}
+
+	bool CheckStatement(Statement* _stmt, std::vector<Expression*>& _stack, Diagnostics& _diagnostics)
+	{
+		switch (_stmt->GetID())
+		{
+			case StmtID::EXPR: return CheckExpression((Expression*)_stmt, _stack, _diagnostics) != nullptr;
+			case StmtID::VARDECL:
+			{
+				VarDecl* decl = (VarDecl*)_stmt;
+				Type* declared = LookupType(decl->GetTypeName());
+				Type* actual = CheckExpression(decl->GetExpr(), _stack, _diagnostics);
+
+				decl->SetType(declared);
+
+				if (!declared)
+				{
+					_diagnostics.Push(DiagnosticType::ERROR_UnknownType, decl->GetPosition(), GetSymbolText(decl->GetTypeName()));
+					return false;
+				}
+				else if (!actual) { return false; }
+				else if (actual != declared)
+				{
+					_diagnostics.Push(DiagnosticType::ERROR_TypeMismatch, decl->GetExpr()->GetPosition(), declared->GetName(), actual->GetName());
+					return false;
+				}
+
+				return true;
+			}
+			case StmtID::BLOCK:
+			{
+				bool success = true;
+
+				for (auto stmt : ((Block*)_stmt)->GetStatements())
+				{
+					if (stmt && !CheckStatement(stmt, _stack, _diagnostics))
+						success = false;
+				}
+
+				return success;
+			}
+		}
+
+		return true;
+	}
+
+	bool Check(Block* _block, Diagnostics& _diagnostics)
+	{
+		std::vector<Expression*> stack;
+		return CheckStatement(_block, stack, _diagnostics);
+	}
+};
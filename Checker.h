@@ -0,0 +1,17 @@
+#pragma once
+
+#include "ast.h"
+
+using namespace ede::ast;
+
+namespace ede::checker
+{
+	//Returns the kernel implementing _op on the given operand types, or NONE if the operation is ill-typed
+	BinopKernel SelectKernel(BinopOP _op, Type* _left, Type* _right);
+
+	//Resolves every declared type name to its interned Type, infers a type for every expression and
+	//selects the kernel of every Binop, so evaluation never has to inspect operand types.
+	//Identifiers take the declared type of their binding, so the block must have been resolved first.
+	//Returns false if a type error was reported.
+	bool Check(Block* _block, Diagnostics& _diagnostics);
+};
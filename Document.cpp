@@ -0,0 +1,210 @@
+#include "pch.h"
+#include "Document.h"
+
+namespace ede::parser
+{
+	//Position of the character after _text when _text starts at _pos, counted like Lexer::Read does
+	Position Advance(Position _pos, std::string_view _text, size_t _tabsize)
+	{
+		for (char c : _text)
+		{
+			if (c == '\n') { _pos.line++; _pos.column = 1; }
+			else if (c == '\t') { _pos.column += _tabsize; }
+			else { _pos.column++; }
+		}
+
+		return _pos;
+	}
+
+	//Maps positions after an edit from the old text to the new one. Only the line the edit ends on changes columns.
+	struct Shift
+	{
+		Position oldEnd, newEnd;
+
+		Position Apply(Position _pos) const
+		{
+			if (_pos.line == oldEnd.line) { return Position(newEnd.line, _pos.column - oldEnd.column + newEnd.column); }
+			else { return Position(_pos.line - oldEnd.line + newEnd.line, _pos.column); }
+		}
+	};
+
+	void ShiftStatement(Statement* _stmt, const Shift& _shift, std::vector<Expression*>& _stack)
+	{
+		if (!_stmt) { return; }
+
+		switch (_stmt->GetID())
+		{
+			case StmtID::BLOCK:
+			{
+				_stmt->SetPosition(_shift.Apply(_stmt->GetPosition()));
+
+				for (Statement* stmt : ((Block*)_stmt)->GetStatements())
+					ShiftStatement(stmt, _shift, _stack);
+			} break;
+			case StmtID::VARDECL:
+			{
+				_stmt->SetPosition(_shift.Apply(_stmt->GetPosition()));
+				ShiftStatement(((VarDecl*)_stmt)->GetExpr(), _shift, _stack);
+			} break;
+			case StmtID::EXPR:
+			{
+				VisitPostOrder((Expression*)_stmt, _stack, [&](Expression* _expr)
+				{
+					_expr->SetPosition(_shift.Apply(_expr->GetPosition()));
+					return true;
+				});
+			} break;
+		}
+	}
+
+	template<typename T>
+	void Replace(std::vector<T>& _vec, size_t _begin, size_t _end, const std::vector<T>& _items)
+	{
+		_vec.erase(_vec.begin() + _begin, _vec.begin() + _end);
+		_vec.insert(_vec.begin() + _begin, _items.begin(), _items.end());
+	}
+
+	Document::Document(std::string _src, size_t _tabsize) : source(std::move(_src)), tabsize(_tabsize), root(nullptr), reparsedBytes(0), lastReparsedBytes(0)
+	{
+		ParseAll();
+	}
+
+	//Parses from _offset, which starts a top-level statement at _position, to the end of the source or until a
+	//statement ends on the boundary of an old segment from _reusable on (shifted by _delta, the growth of the text).
+	//Returns the index of that segment, or the segment count if everything up to the end was parsed.
+	size_t Document::ParseFrom(size_t _offset, Position _position, size_t _reusable, ptrdiff_t _delta, std::vector<Segment>& _segments, std::vector<Statement*>& _statements, std::vector<Diagnostic>& _diagnostics)
+	{
+		Diagnostics sink(SIZE_MAX);
+		Parser parser(std::string_view(source).substr(_offset), tabsize, *arena, sink, _position);
+		size_t reused = segments.size();
+
+		_segments.push_back(Segment{ _offset, _position, 0, 0 });
+
+		while (!parser.IsEOF())
+		{
+			_statements.push_back(parser.ParseStatement());
+			if (!parser.IsDrained()) { continue; }
+
+			size_t cut = parser.GetCursor() - source.data();
+
+			while (_reusable < segments.size() && segments[_reusable].offset + _delta < cut) { _reusable++; }
+
+			if (_reusable < segments.size() && segments[_reusable].offset + _delta == cut)
+			{
+				reused = _reusable;
+				break;
+			}
+
+			_segments.push_back(Segment{ cut, parser.GetPosition(), _statements.size(), sink.GetCount() });
+		}
+
+		for (const Diagnostic& diagnostic : sink.GetDiagnostics())
+		{
+			Diagnostic copy = diagnostic;
+			for (std::string_view& arg : copy.args) { arg = arena->NewString(arg); }
+			_diagnostics.push_back(copy);
+		}
+
+		lastReparsedBytes = parser.GetCursor() - (source.data() + _offset);
+		reparsedBytes += lastReparsedBytes;
+		return reused;
+	}
+
+	void Document::ParseAll()
+	{
+		arena = std::make_unique<Arena>();
+		segments.clear();
+		statements.clear();
+		diagnostics.clear();
+
+		ParseFrom(0, Position(1, 1), 0, 0, segments, statements, diagnostics);
+		reparsedBytes = 0;
+		UpdateRoot();
+	}
+
+	void Document::UpdateRoot()
+	{
+		Position position = (!statements.empty() && statements.front()) ? statements.front()->GetPosition() : Position(1, 1);
+		root = arena->New<Block>(ArrayView<Statement*>(statements.data(), statements.size()), position);
+	}
+
+	Block* Document::Edit(size_t _offset, size_t _length, std::string_view _text)
+	{
+		static const size_t MIN_GARBAGE = 1024 * 1024;
+
+		_offset = std::min(_offset, source.size());
+		_length = std::min(_length, source.size() - _offset);
+
+		//Replaced nodes stay in the arena, so start over once more has been reparsed than a full parse would cost
+		if (reparsedBytes > source.size() * 2 + MIN_GARBAGE)
+		{
+			source.replace(_offset, _length, _text);
+			ParseAll();
+			return root;
+		}
+
+		//The segment holding the byte before the edit is parsed again too, as its last token may run into the new text
+		size_t first = std::upper_bound(segments.begin(), segments.end(), _offset == 0 ? 0 : _offset - 1, [](size_t _value, const Segment& _segment) { return _value < _segment.offset; }) - segments.begin() - 1;
+		Segment start = segments[first];
+
+		Shift shift{ Advance(start.position, std::string_view(source).substr(start.offset, _offset + _length - start.offset), tabsize), Position(1, 1) };
+		source.replace(_offset, _length, _text);
+		shift.newEnd = Advance(start.position, std::string_view(source).substr(start.offset, _offset + _text.size() - start.offset), tabsize);
+
+		//Segments that start after the old text of the edit can be reused once parsing lands on one of their boundaries
+		ptrdiff_t delta = (ptrdiff_t)_text.size() - (ptrdiff_t)_length;
+		size_t reusable = std::lower_bound(segments.begin() + first + 1, segments.end(), _offset + _length, [](const Segment& _segment, size_t _value) { return _segment.offset < _value; }) - segments.begin();
+
+		std::vector<Segment> newSegments;
+		std::vector<Statement*> newStatements;
+		std::vector<Diagnostic> newDiagnostics;
+		size_t reused = ParseFrom(start.offset, start.position, reusable, delta, newSegments, newStatements, newDiagnostics);
+
+		size_t statementEnd = reused < segments.size() ? segments[reused].firstStatement : statements.size();
+		size_t diagnosticEnd = reused < segments.size() ? segments[reused].firstDiagnostic : diagnostics.size();
+		ptrdiff_t statementDelta = (ptrdiff_t)newStatements.size() - (ptrdiff_t)(statementEnd - start.firstStatement);
+		ptrdiff_t diagnosticDelta = (ptrdiff_t)newDiagnostics.size() - (ptrdiff_t)(diagnosticEnd - start.firstDiagnostic);
+		bool linesMoved = shift.newEnd.line != shift.oldEnd.line;
+
+		std::vector<Expression*> stack;
+
+		//Move the reused segments over; if no line was added or removed only those on the line the edit ends on change
+		for (size_t i = reused; i < segments.size(); i++)
+		{
+			Segment& segment = segments[i];
+
+			if (linesMoved || segment.position.line == shift.oldEnd.line)
+			{
+				size_t lastStatement = i + 1 < segments.size() ? segments[i + 1].firstStatement : statements.size();
+				size_t lastDiagnostic = i + 1 < segments.size() ? segments[i + 1].firstDiagnostic : diagnostics.size();
+
+				for (size_t j = segment.firstStatement; j < lastStatement; j++) { ShiftStatement(statements[j], shift, stack); }
+				for (size_t j = segment.firstDiagnostic; j < lastDiagnostic; j++) { diagnostics[j].position = shift.Apply(diagnostics[j].position); }
+				segment.position = shift.Apply(segment.position);
+			}
+
+			segment.offset += delta;
+			segment.firstStatement += statementDelta;
+			segment.firstDiagnostic += diagnosticDelta;
+		}
+
+		for (Segment& segment : newSegments)
+		{
+			segment.firstStatement += start.firstStatement;
+			segment.firstDiagnostic += start.firstDiagnostic;
+		}
+
+		Replace(statements, start.firstStatement, statementEnd, newStatements);
+		Replace(diagnostics, start.firstDiagnostic, diagnosticEnd, newDiagnostics);
+		Replace(segments, first, reused, newSegments);
+
+		UpdateRoot();
+		return root;
+	}
+
+	void Document::ReportDiagnostics(Diagnostics& _diagnostics)
+	{
+		for (const Diagnostic& diagnostic : diagnostics)
+			_diagnostics.Push(diagnostic.type, diagnostic.position, diagnostic.args[0], diagnostic.args[1], diagnostic.args[2]);
+	}
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Parser.h"
+
+namespace ede::parser
+{
+	//Source text kept together with its tree, for long-lived processes that re-parse after every small edit.
+	//The text is cut into segments wherever the parser finished a top-level statement without looking ahead,
+	//so parsing can restart at any segment. An edit is re-lexed and re-parsed from the segment before it until
+	//a statement ends on an old segment boundary past the edit; the statements from there on are reused with
+	//their positions shifted. The tree and diagnostics always equal those of Parse on the current text.
+	class Document
+	{
+		struct Segment
+		{
+			size_t offset; //First byte; the previous segment ends right after its last token
+			Position position; //Lexer position at offset
+			size_t firstStatement, firstDiagnostic;
+		};
+
+		std::string source;
+		size_t tabsize;
+		std::unique_ptr<Arena> arena;
+		std::vector<Segment> segments;
+		std::vector<Statement*> statements;
+		std::vector<Diagnostic> diagnostics; //Arguments live in the arena, the source moves on every edit
+		Block* root;
+		size_t reparsedBytes, lastReparsedBytes; //Since the last full parse, an upper bound on the dead nodes in the arena
+
+		size_t ParseFrom(size_t _offset, Position _position, size_t _reusable, ptrdiff_t _delta, std::vector<Segment>& _segments, std::vector<Statement*>& _statements, std::vector<Diagnostic>& _diagnostics);
+		void ParseAll();
+		void UpdateRoot();
+	public:
+		Document(std::string _src, size_t _tabsize);
+
+		Document(const Document&) = delete;
+		Document& operator=(const Document&) = delete;
+
+		//Replaces _length bytes at _offset with _text and returns the updated tree. Trees returned before are
+		//invalidated; reused statements keep their old resolver and checker annotations until those passes run again.
+		Block* Edit(size_t _offset, size_t _length, std::string_view _text);
+
+		//Reports the parse errors of the current text, in the order Parse reports them
+		void ReportDiagnostics(Diagnostics& _diagnostics);
+
+		const std::string& GetSource() { return source; }
+		Block* GetRoot() { return root; }
+		size_t GetSegmentCount() { return segments.size(); }
+		size_t GetLastReparsedBytes() { return lastReparsedBytes; }
+	};
+};
@@ -0,0 +1,223 @@
+#include "pch.h"
+#include "Driver.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Checker.h"
+#include "Optimizer.h"
+#include "Bytecode.h"
+#include "Jit.h"
+
+namespace ede::driver
+{
+	std::vector<std::string> CollectSources(const std::vector<std::string>& _paths)
+	{
+		std::vector<std::string> result;
+
+		for (const std::string& path : _paths)
+		{
+			std::error_code error;
+
+			if (!std::filesystem::is_directory(path, error))
+			{
+				result.push_back(path);
+				continue;
+			}
+
+			std::vector<std::string> files;
+
+			for (auto& entry : std::filesystem::recursive_directory_iterator(path, error))
+			{
+				if (entry.is_regular_file(error) && entry.path().extension() == ".ede")
+					files.push_back(entry.path().string());
+			}
+
+			std::sort(files.begin(), files.end());
+			result.insert(result.end(), files.begin(), files.end());
+		}
+
+		return result;
+	}
+
+	//The source path with its separators flattened, so sources from different directories get different dumps
+	std::string GetDumpPath(const std::string& _path, const Options& _options)
+	{
+		std::string name = _path;
+		std::replace_if(name.begin(), name.end(), [](char _c) { return _c == '/' || _c == '\\' || _c == ':'; }, '_');
+		return (std::filesystem::path(_options.astDirectory) / (name + "." + std::string(dump::GetFormatName(_options.astFormat)))).string();
+	}
+
+	FileResult CompileFile(const std::string& _path, const Options& _options, std::ostream& _output, serializer::Cache* _cache)
+	{
+		auto start = std::chrono::steady_clock::now();
+		FileResult result;
+		result.path = _path;
+		EDE_STATS_SCOPE(_options.stats ? &result.stats : nullptr);
+		EDE_STATS_STOPWATCH(watch);
+		MappedFile file(_path);
+		Diagnostics diagnostics;
+		EDE_STATS_LAP(watch, READ);
+
+		if (file.IsOpen())
+		{
+			_output << "== " << _path << " (" << file.GetView().size() << " bytes)" << std::endl;
+
+			//Held by pointer so releasing the tree can be timed on its own
+			std::unique_ptr<Arena> arena(new Arena());
+			Block* block = _cache ? _cache->Load(file.GetView(), *arena, _options.limits) : nullptr;
+			result.cached = block != nullptr;
+
+			if (!block)
+			{
+				block = _options.parallelParse ? parser::ParseParallel(file.GetView(), 4, *arena, diagnostics, _options.jobs, _options.limits)
+					: parser::Parse(file.GetView(), 4, *arena, diagnostics, _options.limits);
+				if (_cache && diagnostics.GetCount() == 0) { _cache->Store(file.GetView(), block); } //Before folding rewrites the tree
+			}
+
+			EDE_STATS_LAP(watch, PARSE);
+			uint32_t frameSize = 0;
+			bool mismatch = false, unwritten = false;
+
+			if (_options.fold)
+			{
+				_output << "Folded " << optimizer::FoldConstants(block, *arena, diagnostics) << " nodes" << std::endl;
+				EDE_STATS_LAP(watch, FOLD);
+			}
+
+			resolver::Resolve(block, frameSize, diagnostics);
+			EDE_STATS_LAP(watch, RESOLVE);
+			checker::Check(block, diagnostics);
+			EDE_STATS_LAP(watch, CHECK);
+
+			if (_options.printAst && _options.astDirectory.empty())
+			{
+				dump::Writer writer(_output);
+				dump::Dump(block, _options.astFormat, writer);
+				EDE_STATS_LAP(watch, PRINT);
+			}
+			else if (_options.printAst)
+			{
+				std::string dumpPath = GetDumpPath(_path, _options);
+				dump::Writer writer(dumpPath);
+				dump::Dump(block, _options.astFormat, writer);
+
+				if (!writer.Flush())
+				{
+					_output << "Unable to write " << dumpPath << std::endl;
+					unwritten = true;
+				}
+
+				EDE_STATS_LAP(watch, PRINT);
+			}
+
+			if (_options.run && diagnostics.GetCount() == 0)
+			{
+				std::unique_ptr<jit::Program> program = _options.jit || _options.verifyJit ? jit::Compile(block, frameSize) : nullptr;
+				interpreter::Result value;
+				bool success;
+
+				if (program) { success = program->Run(value, diagnostics); }
+				else
+				{
+					vm::VM vm;
+					success = vm.Run(vm::Compile(block, frameSize), value, diagnostics);
+				}
+
+				EDE_STATS_LAP(watch, RUN);
+
+				if (success)
+					_output << "Result: " << value.ToString() << std::endl;
+
+				if (_options.verifyJit && program)
+				{
+					Diagnostics vmDiagnostics;
+					vm::VM vm;
+					interpreter::Result vmValue;
+					bool vmSuccess = vm.Run(vm::Compile(block, frameSize), vmValue, vmDiagnostics);
+
+					std::ostringstream jitErrors, vmErrors;
+					diagnostics.Print(jitErrors);
+					vmDiagnostics.Print(vmErrors);
+
+					mismatch = vmSuccess != success || vmValue.GetType() != value.GetType() || vmValue.GetBits() != value.GetBits() || jitErrors.str() != vmErrors.str();
+					if (mismatch) { _output << "JIT mismatch, the VM gave " << (vmSuccess ? vmValue.ToString() : vmErrors.str()) << std::endl; }
+					EDE_STATS_LAP(watch, RUN);
+				}
+			}
+
+			diagnostics.Print(_output);
+			result.bytes = file.GetView().size();
+			result.success = diagnostics.GetCount() == 0 && !mismatch && !unwritten;
+			EDE_STATS_LAP(watch, PRINT);
+
+			EDE_STATS_COUNT(files, 1);
+			EDE_STATS_COUNT(bytes, result.bytes);
+			EDE_STATS_COUNT(diagnostics, diagnostics.GetCount());
+			EDE_STATS_COUNT(allocations, arena->GetAllocationCount());
+			EDE_STATS_COUNT(bytesAllocated, arena->GetBytesAllocated());
+			EDE_STATS_COUNT(peakTreeBytes, arena->GetBytesReserved()); //Arenas only grow, so this is the peak
+
+			arena.reset();
+			EDE_STATS_LAP(watch, TEARDOWN);
+		}
+		else { _output << "== " << _path << std::endl << "Unable to open " << _path << std::endl; }
+
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return result;
+	}
+
+	FileResult CompileFile(const std::string& _path, const Options& _options, serializer::Cache* _cache)
+	{
+		std::ostringstream output;
+		FileResult result = CompileFile(_path, _options, output, _cache);
+		result.output = output.str();
+		return result;
+	}
+
+	void CompileFiles(const std::vector<std::string>& _paths, const Options& _options, std::ostream& _output, const std::function<void(const FileResult&)>& _report)
+	{
+		std::vector<FileResult> results(_paths.size());
+		std::vector<bool> done(_paths.size());
+		size_t reported = 0; //Files before this one are printed and released
+		std::mutex mutex;
+		std::unique_ptr<serializer::Cache> cache(_options.cacheDirectory.empty() ? nullptr : new serializer::Cache(_options.cacheDirectory));
+		std::atomic<size_t> next(0);
+		size_t jobs = _options.jobs != 0 ? _options.jobs : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+		//Files are handed out one at a time so a few large files cannot leave workers idle. The file whose turn it is
+		//when it starts prints straight to _output, as nothing else prints until it is done; the others are buffered.
+		auto worker = [&]()
+		{
+			for (size_t i = next++; i < _paths.size(); i = next++)
+			{
+				bool streamed;
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					streamed = i == reported;
+				}
+
+				results[i] = streamed ? CompileFile(_paths[i], _options, _output, cache.get()) : CompileFile(_paths[i], _options, cache.get());
+
+				std::lock_guard<std::mutex> lock(mutex);
+				done[i] = true;
+
+				for (; reported < _paths.size() && done[reported]; reported++)
+				{
+					_output << results[reported].output;
+					_report(results[reported]);
+					results[reported] = FileResult();
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+
+		for (size_t i = 1; i < std::min(jobs, _paths.size()); i++)
+			threads.emplace_back(worker);
+
+		worker();
+
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Utilities.h"
+#include "Serializer.h"
+#include "Parser.h"
+#include "Dump.h"
+#include "Stats.h"
+
+namespace ede::driver
+{
+	struct Options
+	{
+		bool fold = false; //Fold constants before checking
+		bool printAst = false; //Dump the tree of every file
+		dump::Format astFormat = dump::Format::TREE;
+		std::string astDirectory; //Where dumps are streamed to, one file per source, instead of into the output
+		bool run = true; //Run files that compiled without errors
+		bool jit = true; //Run through native code where supported, falling back to the VM
+		bool verifyJit = false; //Also run the VM and fail the file unless both agree bit for bit
+		bool parallelParse = false; //Also split each file at top-level statements and parse the pieces on jobs threads
+		bool stats = false; //Collect per-phase times and counters into FileResult::stats
+		size_t jobs = 0; //Worker count, 0 for one per core
+		std::string cacheDirectory; //Where parsed trees are cached, empty to always parse
+		parser::Limits limits; //Nesting limits; cached trees are checked against the block limit only, expressions were parsed under the limits of the run that stored them
+	};
+
+	//Outcome of compiling one file; output holds everything the file printed, diagnostics included, unless it was streamed
+	struct FileResult
+	{
+		std::string path, output;
+		size_t bytes = 0;
+		double seconds = 0;
+		bool success = false, cached = false; //cached if the tree was loaded from the cache instead of parsed
+#ifndef EDE_NO_STATS
+		stats::Counters stats; //Left zero unless Options::stats
+#endif
+	};
+
+	//Expands directories into the .ede files below them, sorted by path; other paths are kept as given
+	std::vector<std::string> CollectSources(const std::vector<std::string>& _paths);
+
+	//Parses, resolves, checks and optionally runs a single file on the calling thread, printing a header line and
+	//everything else straight to _output; FileResult::output is left empty.
+	//With a cache the tree is loaded from it when present, and stored into it when parsed without errors.
+	FileResult CompileFile(const std::string& _path, const Options& _options, std::ostream& _output, serializer::Cache* _cache = nullptr);
+
+	//Same, with the output collected into FileResult::output
+	FileResult CompileFile(const std::string& _path, const Options& _options, serializer::Cache* _cache = nullptr);
+
+	//Compiles every file on a pool of workers and prints their output to _output in the order of _paths, as soon as a
+	//file and all before it are done. Only files done ahead of their turn are held in memory; with one worker or one file
+	//nothing is. _report gets every result after its output, in the same order, one at a time on any of the workers.
+	void CompileFiles(const std::vector<std::string>& _paths, const Options& _options, std::ostream& _output, const std::function<void(const FileResult&)>& _report);
+};
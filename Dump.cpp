@@ -0,0 +1,569 @@
+#include "pch.h"
+#include "Dump.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace ede::dump
+{
+	std::string_view GetFormatName(Format _format)
+	{
+		switch (_format)
+		{
+			case Format::TREE: return "tree";
+			case Format::COMPACT: return "compact";
+			default: return "json";
+		}
+	}
+
+	bool FindFormat(std::string_view _name, Format& _format)
+	{
+		for (Format format : { Format::TREE, Format::COMPACT, Format::JSON })
+		{
+			if (GetFormatName(format) != _name) { continue; }
+
+			_format = format;
+			return true;
+		}
+
+		return false;
+	}
+
+#pragma region Writer
+	Writer::Writer(std::ostream& _stream) : buffer(new char[BUFFER_SIZE]), used(0), stream(&_stream), fd(-1), ownsFd(false), failed(false) { }
+	Writer::Writer(int _fd) : buffer(new char[BUFFER_SIZE]), used(0), stream(nullptr), fd(_fd), ownsFd(false), failed(false) { }
+
+	Writer::Writer(const std::string& _path) : buffer(new char[BUFFER_SIZE]), used(0), stream(nullptr), fd(-1), ownsFd(true), failed(false)
+	{
+#ifdef _WIN32
+		fd = _open(_path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+		fd = open(_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+		failed = fd < 0;
+	}
+
+	Writer::~Writer()
+	{
+		Flush();
+
+		if (ownsFd && fd >= 0)
+		{
+#ifdef _WIN32
+			_close(fd);
+#else
+			close(fd);
+#endif
+		}
+	}
+
+	void Writer::Drain()
+	{
+		const char* data = buffer.get();
+		size_t size = used;
+		used = 0;
+
+		if (failed) { return; }
+		else if (stream)
+		{
+			stream->write(data, (std::streamsize)size);
+			failed = !*stream;
+			return;
+		}
+
+		while (size != 0)
+		{
+#ifdef _WIN32
+			int written = _write(fd, data, (unsigned int)std::min<size_t>(size, INT_MAX));
+#else
+			ssize_t written = write(fd, data, size);
+			if (written < 0 && errno == EINTR) { continue; }
+#endif
+			if (written <= 0)
+			{
+				failed = true;
+				return;
+			}
+
+			data += written;
+			size -= (size_t)written;
+		}
+	}
+
+	void Writer::WriteLarge(std::string_view _text)
+	{
+		while (!_text.empty())
+		{
+			if (used == BUFFER_SIZE) { Drain(); }
+
+			size_t count = std::min(_text.size(), BUFFER_SIZE - used);
+			std::memcpy(buffer.get() + used, _text.data(), count);
+			used += count;
+			_text.remove_prefix(count);
+		}
+	}
+
+	void Writer::WriteRepeated(char _char, size_t _count)
+	{
+		while (_count != 0)
+		{
+			if (used == BUFFER_SIZE) { Drain(); }
+
+			size_t count = std::min(_count, BUFFER_SIZE - used);
+			std::memset(buffer.get() + used, _char, count);
+			used += count;
+			_count -= count;
+		}
+	}
+
+	void Writer::WriteInt(INT _value)
+	{
+		char text[24];
+		Write(std::string_view(text, std::to_chars(text, text + sizeof(text), _value).ptr - text));
+	}
+
+	void Writer::WriteFloat(FLOAT _value, bool _shortest)
+	{
+		//Fixed notation of the largest doubles takes 309 digits before the point
+		char text[400];
+		auto result = _shortest ? std::to_chars(text, text + sizeof(text), _value) : std::to_chars(text, text + sizeof(text), _value, std::chars_format::fixed, 6);
+		Write(std::string_view(text, result.ptr - text));
+	}
+
+	bool Writer::Flush()
+	{
+		Drain();
+		if (stream && !failed) { failed = !stream->flush(); }
+		return !failed;
+	}
+#pragma endregion
+
+#pragma region Emitter
+	//Turns the events of a walk into the text of one format
+	class Emitter
+	{
+		Writer& writer;
+		Format format;
+		size_t depth; //Indentation of the next TREE line, nesting of the open COMPACT lists
+		bool separate; //A JSON value was completed, the next one needs a comma
+
+		void Line(std::string_view _text)
+		{
+			writer.Write('\n');
+			writer.WriteRepeated(' ', depth);
+			writer.Write("|-");
+			writer.Write(_text);
+		}
+
+		//Writes what goes before any value: a space in COMPACT lists, a comma between JSON values
+		void BeginValue()
+		{
+			if (format == Format::COMPACT && depth != 0) { writer.Write(' '); }
+			else if (format == Format::JSON && separate) { writer.Write(','); }
+		}
+
+		void WriteString(std::string_view _text)
+		{
+			static const char* const HEX = "0123456789abcdef";
+			writer.Write('"');
+
+			for (char c : _text)
+			{
+				if (c == '"' || c == '\\') { writer.Write('\\'); writer.Write(c); }
+				else if ((unsigned char)c < 0x20) { writer.Write("\\u00"); writer.Write(HEX[c >> 4]); writer.Write(HEX[c & 0xF]); }
+				else { writer.Write(c); }
+			}
+
+			writer.Write('"');
+		}
+
+		void BeginObject(std::string_view _kind, Position _position)
+		{
+			writer.Write("{\"kind\":\"");
+			writer.Write(_kind);
+			writer.Write("\",\"line\":");
+			writer.WriteInt((INT)_position.line);
+			writer.Write(",\"column\":");
+			writer.WriteInt((INT)_position.column);
+		}
+
+		//COMPACT and JSON write the shortest exact text; COMPACT keeps a point or exponent so floats stay apart from ints
+		void WriteValue(const Value& _value)
+		{
+			switch (_value.GetType())
+			{
+				case ValueType::INT: writer.WriteInt(_value.AsInt()); return;
+				case ValueType::BOOL:
+				{
+					if (format == Format::TREE) { writer.Write(_value.AsBool() ? '1' : '0'); }
+					else { writer.Write(_value.AsBool() ? "true" : "false"); }
+				} return;
+				case ValueType::FLOAT:
+				{
+					FLOAT value = _value.AsFloat();
+
+					if (format == Format::TREE) { writer.WriteFloat(value, false); }
+					else if (!std::isfinite(value))
+					{
+						std::string_view text = std::isnan(value) ? "nan" : value < 0 ? "-inf" : "inf";
+						if (format == Format::JSON) { WriteString(text); } //JSON has no such numbers
+						else { writer.Write(text); }
+					}
+					else if (format == Format::JSON) { writer.WriteFloat(value, true); }
+					else
+					{
+						char text[32];
+						char* end = std::to_chars(text, text + sizeof(text), value).ptr;
+						writer.Write(std::string_view(text, end - text));
+						if (std::find_if(text, end, [](char _c) { return _c == '.' || _c == 'e'; }) == end) { writer.Write(".0"); }
+					}
+				} return;
+				default: writer.Write(format == Format::JSON ? "null" : "()"); return;
+			}
+		}
+
+	public:
+		Emitter(Writer& _writer, Format _format) : writer(_writer), format(_format), depth(0), separate(false) { }
+
+		void Literal(const Value& _value, Position _position)
+		{
+			if (format == Format::TREE)
+			{
+				Line("Literal: ");
+				WriteValue(_value);
+				return;
+			}
+
+			BeginValue();
+
+			if (format == Format::COMPACT) { WriteValue(_value); }
+			else
+			{
+				static const char* const TYPE_NAMES[] = { "unit", "int", "float", "bool" };
+
+				BeginObject("Literal", _position);
+				writer.Write(",\"type\":\"");
+				writer.Write(TYPE_NAMES[(size_t)_value.GetType()]);
+				writer.Write("\",\"value\":");
+				WriteValue(_value);
+				writer.Write('}');
+			}
+
+			separate = true;
+		}
+
+		void Identifier(Symbol _name, Position _position)
+		{
+			if (format == Format::TREE)
+			{
+				Line("Identifier: ");
+				writer.Write(GetSymbolText(_name));
+				return;
+			}
+
+			BeginValue();
+
+			if (format == Format::COMPACT) { writer.Write(GetSymbolText(_name)); }
+			else
+			{
+				BeginObject("Identifier", _position);
+				writer.Write(",\"name\":");
+				WriteString(GetSymbolText(_name));
+				writer.Write('}');
+			}
+
+			separate = true;
+		}
+
+		void Missing()
+		{
+			if (format == Format::TREE) { return; }
+
+			BeginValue();
+			writer.Write(format == Format::JSON ? "null" : "_");
+			separate = true;
+		}
+
+		void BeginBlock(Position _position)
+		{
+			if (format == Format::TREE) { Line("Block"); }
+			else
+			{
+				BeginValue();
+
+				if (format == Format::COMPACT) { writer.Write("(block"); }
+				else
+				{
+					BeginObject("Block", _position);
+					writer.Write(",\"statements\":[");
+				}
+			}
+
+			depth++;
+			separate = false;
+		}
+
+		void BeginVarDecl(Symbol _varName, Symbol _typeName, Position _position)
+		{
+			if (format == Format::TREE)
+			{
+				Line("Variable Declaration");
+				depth++;
+				Line("VarName: ");
+				writer.Write(GetSymbolText(_varName));
+				Line("TypeName: ");
+				writer.Write(GetSymbolText(_typeName));
+				Line("Expression: ");
+			}
+			else
+			{
+				BeginValue();
+
+				if (format == Format::COMPACT)
+				{
+					writer.Write("(let ");
+					writer.Write(GetSymbolText(_varName));
+					writer.Write(' ');
+					writer.Write(GetSymbolText(_typeName));
+				}
+				else
+				{
+					BeginObject("VarDecl", _position);
+					writer.Write(",\"name\":");
+					WriteString(GetSymbolText(_varName));
+					writer.Write(",\"type\":");
+					WriteString(GetSymbolText(_typeName));
+					writer.Write(",\"expr\":");
+				}
+			}
+
+			depth++;
+			separate = false;
+		}
+
+		void BeginBinop(BinopOP _op, Position _position)
+		{
+			if (format == Format::TREE)
+			{
+				Line("Binop");
+				depth++;
+				Line("OP: ");
+				writer.Write(GetBinopSymbol(_op));
+				Line("Left");
+			}
+			else
+			{
+				BeginValue();
+
+				if (format == Format::COMPACT)
+				{
+					writer.Write('(');
+					writer.Write(GetBinopSymbol(_op));
+				}
+				else
+				{
+					BeginObject("Binop", _position);
+					writer.Write(",\"op\":\"");
+					writer.Write(GetBinopSymbol(_op));
+					writer.Write("\",\"left\":");
+				}
+			}
+
+			depth++;
+			separate = false;
+		}
+
+		//Between the left and the right operand of a Binop
+		void BinopRight()
+		{
+			if (format == Format::TREE)
+			{
+				depth--;
+				Line("Right");
+				depth++;
+			}
+			else if (format == Format::JSON) { writer.Write(",\"right\":"); }
+
+			separate = false;
+		}
+
+		void End(FlatKind _kind)
+		{
+			if (format == Format::TREE)
+			{
+				depth -= _kind == FlatKind::BLOCK ? 1 : 2;
+				return;
+			}
+
+			depth--;
+			writer.Write(format == Format::COMPACT ? ")" : _kind == FlatKind::BLOCK ? "]}" : "}");
+			separate = true;
+		}
+
+		void Finish() { writer.Write('\n'); }
+	};
+#pragma endregion
+
+#pragma region Walk
+	//What the walk needs to know of a node, from either kind of tree
+	template<typename Ref>
+	struct NodeInfo
+	{
+		FlatKind kind;
+		Position position;
+		Value value; //LITERAL
+		Symbol name, typeName; //IDENTIFIER and VARDECL
+		BinopOP op;
+		Ref operands[2]; //Left and right of a BINOP, the initializer of a VARDECL
+		ArrayView<const Ref> statements; //BLOCK
+	};
+
+	//Pre-order walk with an explicit stack of the nodes whose children are being written
+	template<typename Ref, typename Describe>
+	void Walk(Ref _root, Describe _describe, Emitter& _emitter)
+	{
+		struct Frame { NodeInfo<Ref> info; size_t next; };
+		std::vector<Frame> stack;
+
+		auto enter = [&](Ref _node)
+		{
+			if (!_node)
+			{
+				_emitter.Missing();
+				return;
+			}
+
+			NodeInfo<Ref> info = _describe(_node);
+
+			switch (info.kind)
+			{
+				case FlatKind::LITERAL: _emitter.Literal(info.value, info.position); return;
+				case FlatKind::IDENTIFIER: _emitter.Identifier(info.name, info.position); return;
+				case FlatKind::BINOP: _emitter.BeginBinop(info.op, info.position); break;
+				case FlatKind::VARDECL: _emitter.BeginVarDecl(info.name, info.typeName, info.position); break;
+				case FlatKind::BLOCK: _emitter.BeginBlock(info.position); break;
+			}
+
+			stack.push_back(Frame{ info, 0 });
+		};
+
+		enter(_root);
+
+		while (!stack.empty())
+		{
+			Frame& frame = stack.back();
+			size_t next = frame.next++;
+			FlatKind kind = frame.info.kind;
+			size_t count = kind == FlatKind::BLOCK ? frame.info.statements.size : kind == FlatKind::BINOP ? 2 : 1;
+
+			if (next == count)
+			{
+				_emitter.End(kind);
+				stack.pop_back();
+				continue;
+			}
+
+			if (kind == FlatKind::BINOP && next == 1) { _emitter.BinopRight(); }
+			enter(kind == FlatKind::BLOCK ? frame.info.statements[next] : frame.info.operands[next]);
+		}
+
+		_emitter.Finish();
+	}
+
+	NodeInfo<Statement*> DescribeNode(Statement* _node)
+	{
+		NodeInfo<Statement*> info{ FlatKind::BLOCK, _node->GetPosition(), Value(), INVALID_SYMBOL, INVALID_SYMBOL, BinopOP::ADD, { nullptr, nullptr }, {} };
+
+		switch (_node->GetID())
+		{
+			case StmtID::BLOCK:
+			{
+				auto statements = ((Block*)_node)->GetStatements();
+				info.statements = ArrayView<Statement* const>(statements.data, statements.size);
+			} break;
+			case StmtID::VARDECL:
+			{
+				VarDecl* decl = (VarDecl*)_node;
+				info.kind = FlatKind::VARDECL;
+				info.name = decl->GetVarName();
+				info.typeName = decl->GetTypeName();
+				info.operands[0] = decl->GetExpr();
+			} break;
+			case StmtID::EXPR:
+			{
+				Expression* expr = (Expression*)_node;
+
+				switch (expr->GetID())
+				{
+					case ExprID::LITERAL:
+					{
+						info.kind = FlatKind::LITERAL;
+						info.value = ((Literal*)expr)->GetValue();
+					} break;
+					case ExprID::IDENTIFIER:
+					{
+						info.kind = FlatKind::IDENTIFIER;
+						info.name = ((Identifier*)expr)->GetName();
+					} break;
+					case ExprID::BINOP:
+					{
+						Binop* binop = (Binop*)expr;
+						info.kind = FlatKind::BINOP;
+						info.op = binop->GetOP();
+						info.operands[0] = binop->GetLeft();
+						info.operands[1] = binop->GetRight();
+					} break;
+				}
+			} break;
+		}
+
+		return info;
+	}
+#pragma endregion
+
+	void Dump(Statement* _root, Format _format, Writer& _writer)
+	{
+		Emitter emitter(_writer, _format);
+		Walk(_root, DescribeNode, emitter);
+	}
+
+	void Dump(const FlatTree& _tree, NodeRef _root, Format _format, Writer& _writer)
+	{
+		Emitter emitter(_writer, _format);
+
+		Walk(_root, [&](NodeRef _node)
+		{
+			NodeInfo<NodeRef> info{ _tree.GetKind(_node), _tree.GetPosition(_node), Value(), INVALID_SYMBOL, INVALID_SYMBOL, BinopOP::ADD, {}, {} };
+
+			switch (info.kind)
+			{
+				case FlatKind::LITERAL: info.value = _tree.GetLiteral(_node); break;
+				case FlatKind::IDENTIFIER: info.name = _tree.GetIdentifier(_node); break;
+				case FlatKind::BINOP:
+				{
+					const FlatTree::BinopData& binop = _tree.GetBinop(_node);
+					info.op = binop.op;
+					info.operands[0] = binop.left;
+					info.operands[1] = binop.right;
+				} break;
+				case FlatKind::VARDECL:
+				{
+					const FlatTree::VarDeclData& decl = _tree.GetVarDecl(_node);
+					info.name = decl.varName;
+					info.typeName = decl.typeName;
+					info.operands[0] = decl.expr;
+				} break;
+				case FlatKind::BLOCK: info.statements = _tree.GetStatements(_node); break;
+			}
+
+			return info;
+		}, emitter);
+	}
+};
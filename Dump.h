@@ -0,0 +1,79 @@
+#pragma once
+
+#include "FlatAST.h"
+
+using namespace ede::ast;
+
+//Streaming tree dumps. Unlike Node::ToString, which builds the whole text in a StringBuilder, a dump goes through
+//the fixed buffer of a Writer straight to its destination, so its memory use does not depend on the size of the tree.
+
+namespace ede::dump
+{
+	enum class Format : uint8_t
+	{
+		TREE, //The indented format of Node::ToString, byte for byte
+		COMPACT, //One line of S-expressions: (block (let x int (+ 1 2.5)) x)
+		JSON //One object per node with its kind and position
+	};
+
+	std::string_view GetFormatName(Format _format);
+
+	//Returns false if _name is not the name of a format
+	bool FindFormat(std::string_view _name, Format& _format);
+
+	//Buffers output and passes it on in blocks of BUFFER_SIZE bytes, to a stream or a file descriptor.
+	//Write errors are remembered rather than reported, see HasFailed.
+	class Writer
+	{
+		std::unique_ptr<char[]> buffer;
+		size_t used;
+		std::ostream* stream;
+		int fd;
+		bool ownsFd, failed;
+
+		void Drain();
+		void WriteLarge(std::string_view _text);
+	public:
+		static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+		Writer(std::ostream& _stream);
+		Writer(int _fd); //The descriptor is left open
+		Writer(const std::string& _path); //Creates or truncates the file, see IsOpen
+		~Writer();
+
+		Writer(const Writer&) = delete;
+		Writer& operator=(const Writer&) = delete;
+
+		bool IsOpen() { return stream || fd >= 0; }
+		bool HasFailed() { return failed; }
+
+		void Write(char _char)
+		{
+			if (used == BUFFER_SIZE) { Drain(); }
+			buffer[used++] = _char;
+		}
+
+		void Write(std::string_view _text)
+		{
+			if (_text.size() > BUFFER_SIZE - used) { WriteLarge(_text); return; }
+
+			std::memcpy(buffer.get() + used, _text.data(), _text.size());
+			used += _text.size();
+		}
+
+		void WriteRepeated(char _char, size_t _count);
+		void WriteInt(INT _value);
+
+		//_shortest selects the shortest text that reads back as _value; otherwise it is printed like std::to_string
+		void WriteFloat(FLOAT _value, bool _shortest);
+
+		//Passes everything buffered on; returns false if a write has failed
+		bool Flush();
+	};
+
+	//Writes the tree under _root, followed by a newline. Null statements, left by parse errors, are skipped in
+	//the TREE format and written as _ and null in the others. The walk does not recurse.
+	void Dump(Statement* _root, Format _format, Writer& _writer);
+	void Dump(const FlatTree& _tree, NodeRef _root, Format _format, Writer& _writer);
+	inline void Dump(const FlatTree& _tree, Format _format, Writer& _writer) { Dump(_tree, _tree.GetRoot(), _format, _writer); }
+};
@@ -0,0 +1,141 @@
+#include "pch.h"
+#include "Engine.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Checker.h"
+#include "Optimizer.h"
+
+namespace ede::engine
+{
+	PrimitiveID GetPrimitiveID(ValueType _type)
+	{
+		switch (_type)
+		{
+			case ValueType::INT: return PrimitiveID::INT;
+			case ValueType::FLOAT: return PrimitiveID::FLOAT;
+			case ValueType::BOOL: return PrimitiveID::BOOL;
+			default: return PrimitiveID::UNIT;
+		}
+	}
+
+#pragma region Program
+	Program::Program(std::vector<Input> _inputs, vm::Chunk _chunk, std::unique_ptr<jit::Program> _native, batch::Plan _plan)
+		: inputs(std::move(_inputs)), chunk(std::move(_chunk)), native(std::move(_native)), plan(std::move(_plan)) { }
+
+	size_t Program::FindInput(std::string_view _name) const
+	{
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			if (GetSymbolText(inputs[i].name) == _name)
+				return i;
+		}
+
+		return inputs.size();
+	}
+
+	ValueType GetInputType(const Value& _value) { return _value.GetType(); }
+	ValueType GetInputType(const batch::Column& _column) { return _column.type; }
+
+	template<typename T>
+	bool Program::CheckInputs(ArrayView<const T> _inputs, Diagnostics& _diagnostics) const
+	{
+		bool valid = true;
+
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			if (i < _inputs.size && GetInputType(_inputs[i]) == inputs[i].type) { continue; }
+
+			std::string_view found = i < _inputs.size ? GetPrimitiveType(GetPrimitiveID(GetInputType(_inputs[i])))->GetName() : "nothing";
+			_diagnostics.Push(DiagnosticType::ERROR_InvalidInput, Position(0, 0), GetSymbolText(inputs[i].name), GetPrimitiveType(GetPrimitiveID(inputs[i].type))->GetName(), found);
+			valid = false;
+		}
+
+		return valid;
+	}
+
+	bool Program::Run(ArrayView<const Value> _inputs, Context& _context, Result& _result, Diagnostics& _diagnostics) const
+	{
+		if (!CheckInputs(_inputs, _diagnostics))
+		{
+			_result = UNIT();
+			return false;
+		}
+
+		if (!native)
+			return _context.vm.Run(chunk, _result, _diagnostics, ArrayView<const Result>(_inputs.data, inputs.size()));
+
+		_context.frame.resize(native->GetFrameSize());
+
+		for (size_t i = 0; i < inputs.size(); i++)
+			_context.frame[i] = _inputs[i].GetBits();
+
+		return native->Run(_context.frame.data(), _result, _diagnostics);
+	}
+
+	bool Program::RunBatch(ArrayView<const batch::Column> _inputs, size_t _rows, Context& _context, batch::Output& _output, Diagnostics& _diagnostics) const
+	{
+		if (!CheckInputs(_inputs, _diagnostics))
+		{
+			_output = batch::Output{ ValueType::UNIT, std::vector<uint64_t>(_rows), {} };
+			return false;
+		}
+
+		return _context.evaluator.Run(plan, _inputs, _rows, _output, _diagnostics);
+	}
+#pragma endregion
+
+#pragma region Engine
+	bool Engine::DeclareInput(std::string_view _name, ValueType _type)
+	{
+		//Only names the lexer reads back as a single identifier can be referred to
+		Diagnostics diagnostics;
+		parser::Lexer lexer(_name, options.tabsize, diagnostics);
+		parser::Token token = lexer.Next();
+
+		if (token.id != parser::TokenID::IDENTIFIER || token.value.data() != _name.data() || token.value.size() != _name.size())
+			return false;
+
+		for (const Input& input : inputs)
+		{
+			if (input.name == token.symbol)
+				return false;
+		}
+
+		inputs.push_back(Input{ token.symbol, _type });
+		return true;
+	}
+
+	std::shared_ptr<const Program> Engine::Compile(std::string_view _src, Diagnostics& _diagnostics) const
+	{
+		size_t errors = _diagnostics.GetCount();
+		Arena arena;
+		Block* block = parser::Parse(_src, options.tabsize, arena, _diagnostics, options.limits);
+
+		if (options.fold)
+			optimizer::FoldConstants(block, arena, _diagnostics);
+
+		//Inputs are bindings without an initializer in front of the script, the checker never visits them
+		std::vector<VarDecl*> decls;
+		std::vector<ValueType> types;
+
+		for (const Input& input : inputs)
+		{
+			VarDecl* decl = arena.New<VarDecl>(input.name, INVALID_SYMBOL, nullptr, Position(0, 0));
+			decl->SetType(GetPrimitiveType(GetPrimitiveID(input.type)));
+			decls.push_back(decl);
+			types.push_back(input.type);
+		}
+
+		uint32_t frameSize = 0;
+		resolver::Resolve(block, ArrayView<VarDecl* const>(decls.data(), decls.size()), frameSize, _diagnostics);
+		checker::Check(block, _diagnostics);
+
+		if (_diagnostics.GetCount() != errors) { return nullptr; }
+
+		//Neither the chunk nor the native code refer to the tree, so the arena goes away here
+		ArrayView<const ValueType> inputTypes(types.data(), types.size());
+		std::unique_ptr<jit::Program> native = options.jit ? jit::Compile(block, frameSize, inputTypes) : nullptr;
+		return std::make_shared<const Program>(inputs, vm::Compile(block, frameSize), std::move(native), batch::Compile(block, frameSize, inputTypes));
+	}
+#pragma endregion
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Bytecode.h"
+#include "Jit.h"
+#include "Batch.h"
+#include "Parser.h"
+
+namespace ede::engine
+{
+	//A variable the host provides: scripts can read it as if it had been declared before their first statement
+	struct Input
+	{
+		Symbol name;
+		ValueType type;
+	};
+
+	//Scratch memory for running programs. A context can be reused for any number of runs of any programs,
+	//but only by one thread at a time; give every thread its own.
+	class Context
+	{
+		friend class Program;
+
+		vm::VM vm;
+		std::vector<uint64_t> frame;
+		batch::Evaluator evaluator;
+	};
+
+	//A compiled script. Programs are immutable once compiled, so one program can be run by many threads at
+	//once, each with its own Context and Diagnostics. Runs do not share state and never touch the source.
+	class Program
+	{
+		std::vector<Input> inputs;
+		vm::Chunk chunk;
+		std::unique_ptr<jit::Program> native; //nullptr when the JIT is disabled or cannot handle the script
+		batch::Plan plan;
+
+		//Reports every input whose value or column is missing or of the wrong type
+		template<typename T>
+		bool CheckInputs(ArrayView<const T> _inputs, Diagnostics& _diagnostics) const;
+	public:
+		Program(std::vector<Input> _inputs, vm::Chunk _chunk, std::unique_ptr<jit::Program> _native, batch::Plan _plan);
+
+		Program(const Program&) = delete;
+		Program& operator=(const Program&) = delete;
+
+		size_t GetInputCount() const { return inputs.size(); }
+		const Input& GetInput(size_t _index) const { return inputs[_index]; }
+
+		//Index of the input called _name, or GetInputCount() if there is none
+		size_t FindInput(std::string_view _name) const;
+
+		bool IsNative() const { return native != nullptr; }
+
+		//Runs the script with _inputs[i] as the value of input i and returns the value of its last statement.
+		//Inputs that are missing or of the wrong type are reported as ERROR_InvalidInput before anything runs;
+		//otherwise the contract is that of vm::VM::Run.
+		bool Run(ArrayView<const Value> _inputs, Context& _context, Result& _result, Diagnostics& _diagnostics) const;
+
+		//Runs the script once for each of _rows rows, input i taking its values from _inputs[i], and returns
+		//false if any row failed. Every row yields the value and the diagnostic Run would have given it, but
+		//the work is done one operation at a time over whole columns; see batch::Evaluator.
+		bool RunBatch(ArrayView<const batch::Column> _inputs, size_t _rows, Context& _context, batch::Output& _output, Diagnostics& _diagnostics) const;
+	};
+
+	struct Options
+	{
+		size_t tabsize = 4;
+		bool fold = true; //Fold constants before checking
+		bool jit = true; //Run through native code where supported, falling back to the VM
+		parser::Limits limits;
+	};
+
+	//Compiles scripts against a fixed set of inputs. Declare the inputs first; Compile itself does not modify
+	//the engine, so several threads may compile at once.
+	class Engine
+	{
+		std::vector<Input> inputs;
+		Options options;
+	public:
+		Engine(Options _options = Options()) : options(_options) { }
+
+		//Declares an input of _type, visible to every program compiled afterwards. Returns false if _name is
+		//already an input, or is not a valid identifier.
+		bool DeclareInput(std::string_view _name, ValueType _type);
+
+		//Parses, resolves, checks and compiles _src. Errors are reported to _diagnostics, which may refer to _src,
+		//and yield nullptr; the program itself does not refer to _src.
+		std::shared_ptr<const Program> Compile(std::string_view _src, Diagnostics& _diagnostics) const;
+	};
+};
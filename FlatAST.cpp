@@ -0,0 +1,138 @@
+#include "pch.h"
+#include "FlatAST.h"
+
+namespace ede::ast
+{
+	NodeRef FlatTree::AddNode(FlatKind _kind, uint32_t _slot, Position _pos)
+	{
+		kinds.push_back(_kind);
+		slots.push_back(_slot);
+		positions.push_back(PackedPosition{ (uint32_t)_pos.line, (uint32_t)_pos.column });
+		return NodeRef((uint32_t)kinds.size() - 1);
+	}
+
+	NodeRef FlatTree::AddLiteral(Value _value, Position _pos)
+	{
+		literals.push_back(_value);
+		return AddNode(FlatKind::LITERAL, (uint32_t)literals.size() - 1, _pos);
+	}
+
+	NodeRef FlatTree::AddBinop(NodeRef _left, BinopOP _op, NodeRef _right, Position _pos)
+	{
+		binops.push_back(BinopData{ _left, _right, _op });
+		return AddNode(FlatKind::BINOP, (uint32_t)binops.size() - 1, _pos);
+	}
+
+	NodeRef FlatTree::AddVarDecl(Symbol _varName, Symbol _typeName, NodeRef _expr, Position _pos)
+	{
+		varDecls.push_back(VarDeclData{ _varName, _typeName, _expr });
+		return AddNode(FlatKind::VARDECL, (uint32_t)varDecls.size() - 1, _pos);
+	}
+
+	NodeRef FlatTree::AddBlock(const std::vector<NodeRef>& _stmts, Position _pos)
+	{
+		blocks.push_back(BlockData{ (uint32_t)blockChildren.size(), (uint32_t)_stmts.size() });
+		blockChildren.insert(blockChildren.end(), _stmts.begin(), _stmts.end());
+		return AddNode(FlatKind::BLOCK, (uint32_t)blocks.size() - 1, _pos);
+	}
+
+	NodeRef FlatTree::AddIdentifier(Symbol _name, Position _pos)
+	{
+		identifiers.push_back(_name);
+		return AddNode(FlatKind::IDENTIFIER, (uint32_t)identifiers.size() - 1, _pos);
+	}
+
+	ArrayView<const NodeRef> FlatTree::GetStatements(NodeRef _node) const
+	{
+		const BlockData& block = blocks[slots[_node.index]];
+		return ArrayView<const NodeRef>(blockChildren.data() + block.first, block.count);
+	}
+
+	//Produces the same dump as the pointer tree's ToString
+	struct FlatPrinter
+	{
+		const FlatTree& tree;
+		StringBuilder& builder;
+
+		void VisitLiteral(NodeRef, const Value& _value) { builder.WriteLine("Literal: " + _value.ToString()); }
+		void VisitIdentifier(NodeRef, Symbol _name) { builder.WriteLine("Identifier: " + std::string(GetSymbolText(_name))); }
+
+		//Walks nested Binops with an explicit stack like Binop::ToString, so deep expressions cannot overflow the stack
+		void VisitBinop(NodeRef _node, const FlatTree::BinopData&)
+		{
+			std::vector<std::pair<NodeRef, int>> stack;
+			stack.emplace_back(_node, 0);
+
+			while (!stack.empty())
+			{
+				const FlatTree::BinopData& binop = tree.GetBinop(stack.back().first);
+				NodeRef operand;
+
+				switch (stack.back().second++)
+				{
+					case 0:
+					{
+						builder.WriteLine("Binop");
+						builder.Indent();
+						builder.WriteLine("OP: " + BinopOPToString(binop.op));
+						builder.WriteLine("Left");
+						operand = binop.left;
+					} break;
+					case 1:
+					{
+						builder.Dedent();
+						builder.WriteLine("Right");
+						operand = binop.right;
+					} break;
+					default:
+					{
+						builder.Dedent();
+						builder.Dedent();
+						stack.pop_back();
+					} continue;
+				}
+
+				builder.Indent();
+
+				if (tree.GetKind(operand) == FlatKind::BINOP) { stack.emplace_back(operand, 0); }
+				else { tree.Visit(operand, *this); }
+			}
+		}
+
+		void VisitVarDecl(NodeRef, const FlatTree::VarDeclData& _decl)
+		{
+			builder.WriteLine("Variable Declaration");
+			builder.Indent();
+
+			builder.WriteLine("VarName: " + std::string(GetSymbolText(_decl.varName)));
+			builder.WriteLine("TypeName: " + std::string(GetSymbolText(_decl.typeName)));
+
+			builder.WriteLine("Expression: ");
+			builder.Indent();
+			tree.Visit(_decl.expr, *this);
+			builder.Dedent();
+
+			builder.Dedent();
+		}
+
+		void VisitBlock(NodeRef, ArrayView<const NodeRef> _stmts)
+		{
+			builder.WriteLine("Block");
+			builder.Indent();
+
+			for (NodeRef stmt : _stmts)
+			{
+				if (stmt) //Statements that failed to parse
+					tree.Visit(stmt, *this);
+			}
+
+			builder.Dedent();
+		}
+	};
+
+	void FlatTree::ToString(NodeRef _node, StringBuilder& _builder) const
+	{
+		FlatPrinter printer{ *this, _builder };
+		Visit(_node, printer);
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "ast.h"
+
+namespace ede::ast
+{
+	enum class FlatKind : uint8_t { LITERAL, BINOP, VARDECL, BLOCK, IDENTIFIER };
+
+	//32-bit handle to a node of a FlatTree
+	struct NodeRef
+	{
+		static const uint32_t NONE = UINT32_MAX;
+		uint32_t index;
+
+		NodeRef() : index(NONE) { }
+		explicit NodeRef(uint32_t _index) : index(_index) { }
+
+		explicit operator bool() const { return index != NONE; }
+		bool operator==(NodeRef _other) const { return index == _other.index; }
+		bool operator!=(NodeRef _other) const { return index != _other.index; }
+	};
+
+	//Compact alternative to the pointer tree: nodes live in contiguous arrays split by kind,
+	//children are referenced by NodeRef and positions are kept in a side table.
+	//Nodes are stored in the order they were completed, so children always precede their parents.
+	class FlatTree
+	{
+	public:
+		struct BinopData { NodeRef left, right; BinopOP op; };
+		struct VarDeclData { Symbol varName, typeName; NodeRef expr; };
+		struct BlockData { uint32_t first, count; };
+	private:
+		struct PackedPosition { uint32_t line, column; };
+
+		//Indexed by NodeRef
+		std::vector<FlatKind> kinds;
+		std::vector<uint32_t> slots;
+		std::vector<PackedPosition> positions;
+
+		//Indexed by slot
+		std::vector<Value> literals;
+		std::vector<BinopData> binops;
+		std::vector<VarDeclData> varDecls;
+		std::vector<BlockData> blocks;
+		std::vector<Symbol> identifiers;
+
+		std::vector<NodeRef> blockChildren;
+		NodeRef root;
+
+		NodeRef AddNode(FlatKind _kind, uint32_t _slot, Position _pos);
+	public:
+		NodeRef AddLiteral(Value _value, Position _pos);
+		NodeRef AddBinop(NodeRef _left, BinopOP _op, NodeRef _right, Position _pos);
+		NodeRef AddVarDecl(Symbol _varName, Symbol _typeName, NodeRef _expr, Position _pos);
+		NodeRef AddBlock(const std::vector<NodeRef>& _stmts, Position _pos);
+		NodeRef AddIdentifier(Symbol _name, Position _pos);
+		void SetRoot(NodeRef _root) { root = _root; }
+
+		NodeRef GetRoot() const { return root; }
+		size_t GetNodeCount() const { return kinds.size(); }
+		FlatKind GetKind(NodeRef _node) const { return kinds[_node.index]; }
+		Position GetPosition(NodeRef _node) const { return Position(positions[_node.index].line, positions[_node.index].column); }
+
+		const Value& GetLiteral(NodeRef _node) const { return literals[slots[_node.index]]; }
+		const BinopData& GetBinop(NodeRef _node) const { return binops[slots[_node.index]]; }
+		const VarDeclData& GetVarDecl(NodeRef _node) const { return varDecls[slots[_node.index]]; }
+		Symbol GetIdentifier(NodeRef _node) const { return identifiers[slots[_node.index]]; }
+		ArrayView<const NodeRef> GetStatements(NodeRef _node) const;
+
+		//Dispatches to the visitor method matching the node's kind:
+		//VisitLiteral(NodeRef, const Value&), VisitBinop(NodeRef, const BinopData&),
+		//VisitVarDecl(NodeRef, const VarDeclData&), VisitBlock(NodeRef, ArrayView<const NodeRef>)
+		//and VisitIdentifier(NodeRef, Symbol).
+		//Visitors recurse by calling Visit on the children they care about.
+		template<typename Visitor>
+		decltype(auto) Visit(NodeRef _node, Visitor& _visitor) const
+		{
+			switch (kinds[_node.index])
+			{
+				case FlatKind::LITERAL: return _visitor.VisitLiteral(_node, GetLiteral(_node));
+				case FlatKind::BINOP: return _visitor.VisitBinop(_node, GetBinop(_node));
+				case FlatKind::VARDECL: return _visitor.VisitVarDecl(_node, GetVarDecl(_node));
+				case FlatKind::IDENTIFIER: return _visitor.VisitIdentifier(_node, GetIdentifier(_node));
+				default: return _visitor.VisitBlock(_node, GetStatements(_node));
+			}
+		}
+
+		//Calls _func on every node in storage order (children before parents)
+		template<typename Func>
+		void ForEachNode(Func _func) const
+		{
+			for (uint32_t i = 0; i < (uint32_t)kinds.size(); i++)
+				_func(NodeRef(i), kinds[i]);
+		}
+
+		void ToString(NodeRef _node, StringBuilder& _builder) const;
+		void ToString(StringBuilder& _builder) const { ToString(root, _builder); }
+	};
+};
@@ -3,68 +3,126 @@
 
 namespace ede::interpreter
 {
-	Result EvaluateExpression(Expression* _expr)
+	EvalStatus EvaluateBinop(BinopOP _op, const Result& _left, const Result& _right, Result& _result)
 	{
-		switch (_expr->GetID())
+		if (_left.GetType() != _right.GetType()) { return EvalStatus::INVALID_OPERANDS; }
+
+		switch (_left.GetType())
 		{
-			case ExprID::LITERAL:
+			case ValueType::INT:
 			{
-				Literal* literal = (Literal*)_expr;
-
-				return std::visit(overloaded{
-					[](UNIT _val) { return Result(_val); },
-					[](INT _val) { return Result(_val); },
-					[](FLOAT _val) { return Result(_val); },
-					[](BOOL _val) { return Result(_val); },
-					}, literal->GetValue());
-			} break;
-			case ExprID::BINOP:
+				INT value = 0;
+				EvalStatus status = IntBinop(_op, _left.AsInt(), _right.AsInt(), value);
+				_result = value;
+				return status;
+			}
+			case ValueType::FLOAT:
 			{
-				Binop* binop = (Binop*)_expr;
-				Result left = EvaluateExpression(binop->GetLeft()), right = EvaluateExpression(binop->GetRight());
+				_result = FloatBinop(_op, _left.AsFloat(), _right.AsFloat());
+				return EvalStatus::OK;
+			}
+			default: return EvalStatus::INVALID_OPERANDS;
+		}
+	}
+
+	DiagnosticType GetStatusDiagnostic(EvalStatus _status)
+	{
+		switch (_status)
+		{
+			case EvalStatus::DIVISION_BY_ZERO: return DiagnosticType::ERROR_DivisionByZero;
+			case EvalStatus::INTEGER_OVERFLOW: return DiagnosticType::ERROR_IntegerOverflow;
+			default: return DiagnosticType::ERROR_InvalidOperands;
+		}
+	}
+
+	//Statements are evaluated recursively, expressions with VisitPostOrder and a stack of operands
+	class Evaluator
+	{
+		Frame frame;
+		std::vector<Expression*> stack;
+		std::vector<Result> operands;
+		Diagnostics& diagnostics;
 
-				switch (binop->GetOP())
+		bool EvaluateExpression(Expression* _expr, Result& _result)
+		{
+			operands.clear();
+
+			bool success = VisitPostOrder(_expr, stack, [&](Expression* _node)
+			{
+				switch (_node->GetID())
 				{
-					case BinopOP::ADD:
-					{
-						return INT(0);
-					} break;
-					case BinopOP::SUB:
-					{
-						return INT(0);
-					} break;
-					case BinopOP::MUL:
+					case ExprID::LITERAL: operands.push_back(((Literal*)_node)->GetValue()); return true;
+					case ExprID::IDENTIFIER: operands.push_back(frame[((Identifier*)_node)->GetDecl()->GetSlot()]); return true;
+					case ExprID::BINOP:
 					{
-						return INT(0);
-					} break;
-					case BinopOP::DIV:
-					{
-						return INT(0);
-					} break;
-					case BinopOP::MOD:
+						Binop* binop = (Binop*)_node;
+						Result right = operands.back();
+						operands.pop_back();
+
+						EvalStatus status = EvaluateBinop(binop->GetOP(), operands.back(), right, operands.back());
+						if (status == EvalStatus::OK) { return true; }
+
+						diagnostics.Push(GetStatusDiagnostic(status), binop->GetPosition(), GetBinopSymbol(binop->GetOP()));
+						return false;
+					}
+				}
+
+				operands.push_back(UNIT());
+				return true;
+			});
+
+			if (success) { _result = operands.back(); }
+			return success;
+		}
+
+		bool EvaluateStatement(Statement* _stmt, Result& _result)
+		{
+			switch (_stmt->GetID())
+			{
+				case StmtID::EXPR: return EvaluateExpression((Expression*)_stmt, _result);
+				case StmtID::VARDECL:
+				{
+					VarDecl* decl = (VarDecl*)_stmt;
+					if (!EvaluateExpression(decl->GetExpr(), frame[decl->GetSlot()])) { return false; }
+
+					_result = UNIT();
+					return true;
+				}
+				case StmtID::BLOCK:
+				{
+					_result = UNIT();
+
+					for (auto stmt : ((Block*)_stmt)->GetStatements())
 					{
-						return INT(0);
-					} break;
+						if (stmt && !EvaluateStatement(stmt, _result))
+							return false;
+					}
+
+					return true;
 				}
-			} break;
+			}
+
+			_result = UNIT();
+			return true;
 		}
+	public:
+		Evaluator(uint32_t _frameSize, Diagnostics& _diagnostics) : frame(_frameSize), diagnostics(_diagnostics) { }
 
-		return UNIT();
-	}
+		Result Run(Statement* _stmt)
+		{
+			Result result;
+			return EvaluateStatement(_stmt, result) ? result : Result(UNIT());
+		}
+	};
 
-	Result Evaluate(Node* _node)
+	Result Evaluate(Node* _node, uint32_t _frameSize, Diagnostics& _diagnostics)
 	{
 		switch (_node->GetID())
 		{
 			case NodeID::STMT:
 			{
-				Statement* stmt = (Statement*)_node;
-
-				switch (stmt->GetID())
-				{
-					case StmtID::EXPR: return EvaluateExpression((Expression*)stmt);
-					default: return UNIT();
-				}
+				Evaluator evaluator(_frameSize, _diagnostics);
+				return evaluator.Run((Statement*)_node);
 			} break;
 			default: return UNIT();
 		}
@@ -6,7 +6,87 @@ using namespace ede::ast;
 
 namespace ede::interpreter
 {
-	typedef std::variant<UNIT, INT, FLOAT, BOOL> Result;
+	typedef Value Result;
+	typedef std::vector<Result> Frame;
 
-	Result Evaluate(Node* _node);
-};
\ No newline at end of file
+	enum class EvalStatus { OK, DIVISION_BY_ZERO, INTEGER_OVERFLOW, INVALID_OPERANDS };
+
+#pragma region Kernels
+	//Integer operations are checked: overflow and division by zero are errors rather than undefined behaviour
+#if defined(__GNUC__) || defined(__clang__)
+	inline bool CheckedAdd(INT _a, INT _b, INT& _result) { return !__builtin_add_overflow(_a, _b, &_result); }
+	inline bool CheckedSub(INT _a, INT _b, INT& _result) { return !__builtin_sub_overflow(_a, _b, &_result); }
+	inline bool CheckedMul(INT _a, INT _b, INT& _result) { return !__builtin_mul_overflow(_a, _b, &_result); }
+#else
+	inline bool CheckedAdd(INT _a, INT _b, INT& _result)
+	{
+		if ((_b > 0 && _a > LLONG_MAX - _b) || (_b < 0 && _a < LLONG_MIN - _b)) { return false; }
+		_result = _a + _b;
+		return true;
+	}
+
+	inline bool CheckedSub(INT _a, INT _b, INT& _result)
+	{
+		if ((_b < 0 && _a > LLONG_MAX + _b) || (_b > 0 && _a < LLONG_MIN + _b)) { return false; }
+		_result = _a - _b;
+		return true;
+	}
+
+	inline bool CheckedMul(INT _a, INT _b, INT& _result)
+	{
+		if (_a > 0 ? (_b > 0 ? _a > LLONG_MAX / _b : _b < LLONG_MIN / _a)
+			: (_b > 0 ? _a < LLONG_MIN / _b : (_a != 0 && _b < LLONG_MAX / _a))) { return false; }
+
+		_result = _a * _b;
+		return true;
+	}
+#endif
+
+	inline EvalStatus IntBinop(BinopOP _op, INT _a, INT _b, INT& _result)
+	{
+		switch (_op)
+		{
+			case BinopOP::ADD: return CheckedAdd(_a, _b, _result) ? EvalStatus::OK : EvalStatus::INTEGER_OVERFLOW;
+			case BinopOP::SUB: return CheckedSub(_a, _b, _result) ? EvalStatus::OK : EvalStatus::INTEGER_OVERFLOW;
+			case BinopOP::MUL: return CheckedMul(_a, _b, _result) ? EvalStatus::OK : EvalStatus::INTEGER_OVERFLOW;
+			case BinopOP::DIV:
+			{
+				if (_b == 0) { return EvalStatus::DIVISION_BY_ZERO; }
+				if (_a == LLONG_MIN && _b == -1) { return EvalStatus::INTEGER_OVERFLOW; }
+				_result = _a / _b;
+				return EvalStatus::OK;
+			}
+			case BinopOP::MOD:
+			{
+				if (_b == 0) { return EvalStatus::DIVISION_BY_ZERO; }
+				_result = _b == -1 ? 0 : _a % _b;
+				return EvalStatus::OK;
+			}
+		}
+
+		return EvalStatus::INVALID_OPERANDS;
+	}
+
+	//Floating point operations follow IEEE 754; modulo has the semantics of std::fmod
+	inline FLOAT FloatBinop(BinopOP _op, FLOAT _a, FLOAT _b)
+	{
+		switch (_op)
+		{
+			case BinopOP::ADD: return _a + _b;
+			case BinopOP::SUB: return _a - _b;
+			case BinopOP::MUL: return _a * _b;
+			case BinopOP::DIV: return _a / _b;
+			default: return std::fmod(_a, _b);
+		}
+	}
+#pragma endregion
+
+	//Arithmetic is only defined between two INTs or two FLOATs
+	EvalStatus EvaluateBinop(BinopOP _op, const Result& _left, const Result& _right, Result& _result);
+	DiagnosticType GetStatusDiagnostic(EvalStatus _status);
+
+	//Evaluates a resolved statement or block; a block yields the value of its last statement.
+	//Bindings live in a frame of _frameSize slots indexed by the slots the resolver assigned.
+	//Evaluation stops at the first runtime error, which is reported as a diagnostic, and yields UNIT.
+	Result Evaluate(Node* _node, uint32_t _frameSize, Diagnostics& _diagnostics);
+};
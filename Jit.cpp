@@ -0,0 +1,581 @@
+#include "pch.h"
+#include "Jit.h"
+
+#if !defined(EDE_NO_JIT) && defined(__x86_64__) && !defined(_WIN32)
+#define EDE_JIT
+#include <sys/mman.h>
+#endif
+
+namespace ede::jit
+{
+#pragma region Assembler
+	enum Reg : uint8_t { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7, R12 = 12 };
+
+	//Second operand of an instruction: a register, a slot at [rbx + disp] or a pooled constant at [rip + disp]
+	struct Operand
+	{
+		enum Kind : uint8_t { REG, SLOT, CONSTANT } kind;
+		uint32_t index; //Register number, slot or constant index
+	};
+
+	//Emits the handful of x86-64 instructions the code generator needs, in their shortest encodings
+	class Assembler
+	{
+		std::vector<uint8_t> code;
+		std::vector<uint64_t> constants;
+		std::unordered_map<uint64_t, uint32_t> constantIndices;
+		std::vector<std::pair<size_t, uint32_t>> constantUses; //disp32 to patch, constant index
+
+		void Byte(uint8_t _byte) { code.push_back(_byte); }
+		void Bytes(std::initializer_list<uint8_t> _bytes) { code.insert(code.end(), _bytes); }
+		void Imm32(uint32_t _value) { for (int i = 0; i < 4; i++) { Byte((uint8_t)(_value >> (i * 8))); } }
+		void Imm64(uint64_t _value) { for (int i = 0; i < 8; i++) { Byte((uint8_t)(_value >> (i * 8))); } }
+
+		void ModRM(uint8_t _reg, Operand _operand)
+		{
+			switch (_operand.kind)
+			{
+				case Operand::REG: Byte(0xC0 | ((_reg & 7) << 3) | (_operand.index & 7)); break;
+				case Operand::SLOT:
+				{
+					uint32_t disp = _operand.index * 8;
+					if (disp < 0x80) { Bytes({ (uint8_t)(0x40 | ((_reg & 7) << 3) | RBX), (uint8_t)disp }); }
+					else { Byte(0x80 | ((_reg & 7) << 3) | RBX); Imm32(disp); }
+				} break;
+				case Operand::CONSTANT:
+				{
+					Byte(((_reg & 7) << 3) | 5);
+					constantUses.emplace_back(code.size(), _operand.index);
+					Imm32(0);
+				} break;
+			}
+		}
+
+		//REX.W prefix with the extension bits of _reg and of a register operand
+		void RexW(uint8_t _reg, Operand _operand) { Byte(0x48 | ((_reg >> 3) << 2) | (_operand.kind == Operand::REG ? _operand.index >> 3 : 0)); }
+	public:
+		static Operand Register(Reg _reg) { return Operand{ Operand::REG, _reg }; }
+		static Operand Slot(uint32_t _slot) { return Operand{ Operand::SLOT, _slot }; }
+
+		Operand Constant(uint64_t _bits)
+		{
+			auto result = constantIndices.emplace(_bits, (uint32_t)constants.size());
+			if (result.second) { constants.push_back(_bits); }
+			return Operand{ Operand::CONSTANT, result.first->second };
+		}
+
+		void Push(Reg _reg) { if (_reg >= 8) { Byte(0x41); } Byte(0x50 | (_reg & 7)); }
+		void Pop(Reg _reg) { if (_reg >= 8) { Byte(0x41); } Byte(0x58 | (_reg & 7)); }
+
+		//mov, and the integer ALU forms op r64, r/m64 selected by _opcode
+		void Op(uint8_t _opcode, Reg _dst, Operand _src) { RexW(_dst, _src); Byte(_opcode); ModRM(_dst, _src); }
+		void Load(Reg _dst, Operand _src) { Op(0x8B, _dst, _src); }
+		void Store(uint32_t _slot, Reg _src) { RexW(_src, Slot(_slot)); Byte(0x89); ModRM(_src, Slot(_slot)); }
+		void Mov(Reg _dst, Reg _src) { Load(_dst, Register(_src)); }
+		void Imul(Reg _dst, Operand _src) { RexW(_dst, _src); Bytes({ 0x0F, 0xAF }); ModRM(_dst, _src); }
+
+		void MovImm(Reg _dst, uint64_t _value)
+		{
+			if (_value <= UINT32_MAX) { Byte(0xB8 | _dst); Imm32((uint32_t)_value); } //Zero-extends
+			else if ((int64_t)_value >= INT32_MIN && (int64_t)_value < 0) { Bytes({ 0x48, 0xC7, (uint8_t)(0xC0 | _dst) }); Imm32((uint32_t)_value); }
+			else { Bytes({ 0x48, (uint8_t)(0xB8 | _dst) }); Imm64(_value); }
+		}
+
+		//add (/0) and sub (/5) rax with a sign-extended immediate
+		void AluImm(uint8_t _ext, int32_t _value)
+		{
+			if (_value >= -128 && _value < 128) { Bytes({ 0x48, 0x83, (uint8_t)(0xC0 | (_ext << 3)), (uint8_t)_value }); }
+			else { Bytes({ 0x48, 0x81, (uint8_t)(0xC0 | (_ext << 3)) }); Imm32((uint32_t)_value); }
+		}
+
+		void ImulImm(int32_t _value)
+		{
+			if (_value >= -128 && _value < 128) { Bytes({ 0x48, 0x6B, 0xC0, (uint8_t)_value }); }
+			else { Bytes({ 0x48, 0x69, 0xC0 }); Imm32((uint32_t)_value); }
+		}
+
+		void CqoIdivRcx() { Bytes({ 0x48, 0x99, 0x48, 0xF7, 0xF9 }); }
+		void NegRax() { Bytes({ 0x48, 0xF7, 0xD8 }); }
+		void TestRcx() { Bytes({ 0x48, 0x85, 0xC9 }); }
+		void CmpRcxMinusOne() { Bytes({ 0x48, 0x83, 0xF9, 0xFF }); }
+		void CmpRaxRdx() { Bytes({ 0x48, 0x39, 0xD0 }); }
+		void ZeroEax() { Bytes({ 0x31, 0xC0 }); }
+
+		//Scalar double instructions xmm, xmm/m64 selected by _opcode: movsd load, add, sub, mul, div
+		void SD(uint8_t _opcode, uint8_t _xmm, Operand _src) { Bytes({ 0xF2, 0x0F, _opcode }); ModRM(_xmm, _src); }
+		void StoreSD(uint32_t _slot, uint8_t _xmm) { Bytes({ 0xF2, 0x0F, 0x11 }); ModRM(_xmm, Slot(_slot)); }
+		void PushXmm0() { Bytes({ 0x48, 0x83, 0xEC, 0x08, 0xF2, 0x0F, 0x11, 0x04, 0x24 }); }
+		void PopXmm0() { Bytes({ 0xF2, 0x0F, 0x10, 0x04, 0x24, 0x48, 0x83, 0xC4, 0x08 }); }
+		void MovapdXmm1Xmm0() { Bytes({ 0x66, 0x0F, 0x28, 0xC8 }); }
+		void SubRsp8() { Bytes({ 0x48, 0x83, 0xEC, 0x08 }); }
+		void AddRsp8() { Bytes({ 0x48, 0x83, 0xC4, 0x08 }); }
+		void CallRax() { Bytes({ 0xFF, 0xD0 }); }
+
+		//Result and frame handling
+		void StoreResultRax() { Bytes({ 0x49, 0x89, 0x04, 0x24 }); } //mov [r12], rax
+		void StoreResultXmm0() { Bytes({ 0xF2, 0x41, 0x0F, 0x11, 0x04, 0x24 }); } //movsd [r12], xmm0
+		void RestoreRsp() { Bytes({ 0x48, 0x8D, 0x65, 0xF0 }); } //lea rsp, [rbp - 16]
+		void MovEax(uint32_t _value) { Byte(0xB8); Imm32(_value); }
+		void Ret() { Byte(0xC3); }
+
+		//Jumps with a 32-bit displacement; return the offset to patch once the target is known
+		size_t Jcc(uint8_t _condition) { Bytes({ 0x0F, (uint8_t)(0x80 | _condition) }); Imm32(0); return code.size() - 4; }
+		size_t Jmp() { Byte(0xE9); Imm32(0); return code.size() - 4; }
+		void Patch(size_t _at, size_t _target) { uint32_t rel = (uint32_t)(_target - (_at + 4)); std::memcpy(&code[_at], &rel, 4); }
+
+		size_t GetOffset() { return code.size(); }
+
+		//Appends the constant pool after the code and resolves the references to it
+		const std::vector<uint8_t>& Finish()
+		{
+			while (code.size() % 8) { Byte(0xCC); }
+
+			size_t pool = code.size();
+			for (uint64_t constant : constants) { Imm64(constant); }
+			for (auto& use : constantUses) { Patch(use.first, pool + use.second * 8); }
+
+			return code;
+		}
+	};
+
+	static const uint8_t CC_O = 0x0, CC_E = 0x4, CC_NE = 0x5;
+	static const uint8_t OP_ADD = 0x03, OP_SUB = 0x2B;
+	static const uint8_t SD_LOAD = 0x10, SD_ADD = 0x58, SD_MUL = 0x59, SD_SUB = 0x5C, SD_DIV = 0x5E;
+#pragma endregion
+
+#pragma region Compiler
+	//Generates straight-line code: expression values live in rax (INT, BOOL, UNIT) or xmm0 (FLOAT), slots are
+	//addressed from rbx, and right operands are used in place when they are literals or identifiers. Left
+	//operands wait on the native stack while a compound right operand is computed. Operations run in the
+	//VM's order, so the first error is the one the VM reports.
+	class Compiler
+	{
+		Assembler as;
+		std::vector<ErrorSite> sites;
+		std::vector<std::pair<size_t, size_t>> siteJumps; //Jump to patch, site index
+		std::vector<ValueType> slotTypes;
+		struct Pending { Binop* binop; bool rightPushed; };
+
+		//Temporaries a block may keep on the native stack at once
+		static constexpr size_t MAX_TEMPORARIES = 4096;
+
+		std::vector<Pending> pending;
+		size_t depth; //Temporaries pushed, to keep calls 16-byte aligned
+		bool supported;
+
+		void JumpToSite(size_t _jump, EvalStatus _status, Binop* _binop)
+		{
+			siteJumps.emplace_back(_jump, sites.size());
+			sites.push_back(ErrorSite{ _status, _binop->GetPosition(), _binop->GetOP() });
+		}
+
+		VarDecl* GetDecl(Expression* _expr)
+		{
+			VarDecl* decl = ((Identifier*)_expr)->GetDecl();
+			if (decl && decl->GetSlot() < slotTypes.size()) { return decl; }
+
+			supported = false;
+			return nullptr;
+		}
+
+		//Integer division with the VM's checks; a literal divisor settles them while compiling
+		void CompileDivision(Binop* _binop, bool _isMod, Operand _divisor, const Value* _literal)
+		{
+			if (_literal)
+			{
+				INT divisor = _literal->AsInt();
+
+				if (divisor == 0) { JumpToSite(as.Jmp(), EvalStatus::DIVISION_BY_ZERO, _binop); }
+				else if (divisor == -1 && _isMod) { as.ZeroEax(); }
+				else if (divisor == -1)
+				{
+					as.NegRax();
+					JumpToSite(as.Jcc(CC_O), EvalStatus::INTEGER_OVERFLOW, _binop);
+				}
+				else
+				{
+					as.MovImm(RCX, (uint64_t)divisor);
+					as.CqoIdivRcx();
+					if (_isMod) { as.Mov(RAX, RDX); }
+				}
+
+				return;
+			}
+
+			if (_divisor.kind != Operand::REG) { as.Load(RCX, _divisor); }
+
+			as.TestRcx();
+			JumpToSite(as.Jcc(CC_E), EvalStatus::DIVISION_BY_ZERO, _binop);
+			as.CmpRcxMinusOne();
+			size_t notMinusOne = as.Jcc(CC_NE);
+
+			//x % -1 is 0, x / -1 overflows for LLONG_MIN; idiv would trap on both
+			size_t done = 0;
+			if (_isMod)
+			{
+				as.ZeroEax();
+				done = as.Jmp();
+			}
+			else
+			{
+				as.MovImm(RDX, (uint64_t)LLONG_MIN);
+				as.CmpRaxRdx();
+				JumpToSite(as.Jcc(CC_E), EvalStatus::INTEGER_OVERFLOW, _binop);
+			}
+
+			as.Patch(notMinusOne, as.GetOffset());
+			as.CqoIdivRcx();
+
+			if (_isMod)
+			{
+				as.Mov(RAX, RDX);
+				as.Patch(done, as.GetOffset());
+			}
+		}
+
+		//Operand of _binop's right side when it is used in place, a literal or an identifier
+		bool GetRightOperand(Binop* _binop, Operand& _operand)
+		{
+			Expression* right = _binop->GetRight();
+			bool isFloat = _binop->GetKernel() >= BinopKernel::ADD_FLOAT;
+
+			if (right->GetID() == ExprID::LITERAL)
+			{
+				_operand = isFloat ? as.Constant(((Literal*)right)->GetValue().GetBits()) : Operand{ Operand::CONSTANT, 0 };
+				return true;
+			}
+			else if (right->GetID() != ExprID::IDENTIFIER) { return false; }
+
+			VarDecl* decl = GetDecl(right);
+			_operand = Assembler::Slot(decl ? decl->GetSlot() : 0);
+			return true;
+		}
+
+		//Applies _binop to the left operand in rax or xmm0 and _operand
+		ValueType CompileBinop(Binop* _binop, Operand _operand)
+		{
+			BinopKernel kernel = _binop->GetKernel();
+			bool isFloat = kernel >= BinopKernel::ADD_FLOAT;
+			Expression* right = _binop->GetRight();
+			const Value* literal = right->GetID() == ExprID::LITERAL ? &((Literal*)right)->GetValue() : nullptr;
+
+			//Integer literals become immediates when they fit, otherwise they go through rcx
+			INT imm = literal && !isFloat ? literal->AsInt() : 0;
+			bool fits = literal && !isFloat && imm >= INT32_MIN && imm <= INT32_MAX;
+
+			if (literal && !isFloat && !fits && kernel != BinopKernel::DIV_INT && kernel != BinopKernel::MOD_INT)
+			{
+				as.MovImm(RCX, (uint64_t)imm);
+				_operand = Assembler::Register(RCX);
+			}
+
+			switch (kernel)
+			{
+				case BinopKernel::ADD_INT:
+				case BinopKernel::SUB_INT:
+				{
+					uint8_t ext = kernel == BinopKernel::ADD_INT ? 0 : 5;
+					if (fits) { as.AluImm(ext, (int32_t)imm); }
+					else { as.Op(kernel == BinopKernel::ADD_INT ? OP_ADD : OP_SUB, RAX, _operand); }
+					JumpToSite(as.Jcc(CC_O), EvalStatus::INTEGER_OVERFLOW, _binop);
+				} break;
+				case BinopKernel::MUL_INT:
+				{
+					if (fits) { as.ImulImm((int32_t)imm); }
+					else { as.Imul(RAX, _operand); }
+					JumpToSite(as.Jcc(CC_O), EvalStatus::INTEGER_OVERFLOW, _binop);
+				} break;
+				case BinopKernel::DIV_INT: CompileDivision(_binop, false, _operand, literal); break;
+				case BinopKernel::MOD_INT: CompileDivision(_binop, true, _operand, literal); break;
+				case BinopKernel::ADD_FLOAT: as.SD(SD_ADD, 0, _operand); break;
+				case BinopKernel::SUB_FLOAT: as.SD(SD_SUB, 0, _operand); break;
+				case BinopKernel::MUL_FLOAT: as.SD(SD_MUL, 0, _operand); break;
+				case BinopKernel::DIV_FLOAT: as.SD(SD_DIV, 0, _operand); break;
+				case BinopKernel::MOD_FLOAT:
+				{
+					//Call the same fmod the VM uses, so results are bit-identical
+					double (*fmod)(double, double) = std::fmod;
+
+					if (_operand.kind != Operand::REG) { as.SD(SD_LOAD, 1, _operand); }
+					if (depth % 2) { as.SubRsp8(); }
+					as.MovImm(RAX, (uint64_t)(uintptr_t)fmod);
+					as.CallRax();
+					if (depth % 2) { as.AddRsp8(); }
+				} break;
+				default: break;
+			}
+
+			return isFloat ? ValueType::FLOAT : ValueType::INT;
+		}
+
+		//Loads a literal or an identifier
+		ValueType CompileLeaf(Expression* _expr)
+		{
+			switch (_expr->GetID())
+			{
+				case ExprID::LITERAL:
+				{
+					const Value& value = ((Literal*)_expr)->GetValue();
+					if (value.IsFloat()) { as.SD(SD_LOAD, 0, as.Constant(value.GetBits())); }
+					else { as.MovImm(RAX, value.GetBits()); }
+					return value.GetType();
+				}
+				case ExprID::IDENTIFIER:
+				{
+					VarDecl* decl = GetDecl(_expr);
+					if (!decl) { return ValueType::UNIT; }
+
+					ValueType type = slotTypes[decl->GetSlot()];
+					if (type == ValueType::FLOAT) { as.SD(SD_LOAD, 0, Assembler::Slot(decl->GetSlot())); }
+					else { as.Load(RAX, Assembler::Slot(decl->GetSlot())); }
+					return type;
+				}
+				default: break;
+			}
+
+			supported = false;
+			return ValueType::UNIT;
+		}
+
+		//Leaves the value in rax, or xmm0 for FLOAT. Binops whose left operand is being computed, or whose left
+		//operand waits on the native stack for the right one, are kept in pending instead of recursing.
+		ValueType CompileExpression(Expression* _expr)
+		{
+			Expression* next = _expr;
+			ValueType type = ValueType::UNIT;
+			pending.clear();
+
+			for (;;)
+			{
+				for (; next->GetID() == ExprID::BINOP; next = ((Binop*)next)->GetLeft())
+				{
+					if (((Binop*)next)->GetKernel() == BinopKernel::NONE)
+					{
+						supported = false;
+						return ValueType::UNIT;
+					}
+
+					pending.push_back(Pending{ (Binop*)next, false });
+				}
+
+				type = CompileLeaf(next);
+
+				//Finish every Binop whose operands are done, until one needs a compound right operand computed
+				for (next = nullptr; supported && !pending.empty();)
+				{
+					Pending& top = pending.back();
+					bool isFloat = top.binop->GetKernel() >= BinopKernel::ADD_FLOAT;
+					Operand operand;
+
+					if (top.rightPushed)
+					{
+						depth--;
+
+						if (isFloat)
+						{
+							as.MovapdXmm1Xmm0();
+							as.PopXmm0();
+							operand = Assembler::Register((Reg)1);
+						}
+						else
+						{
+							as.Mov(RCX, RAX);
+							as.Pop(RAX);
+							operand = Assembler::Register(RCX);
+						}
+					}
+					else if (!GetRightOperand(top.binop, operand))
+					{
+						//The native stack is bounded, deeper right-nested trees are left to the VM
+						if (depth == MAX_TEMPORARIES)
+						{
+							supported = false;
+							break;
+						}
+
+						if (isFloat) { as.PushXmm0(); } else { as.Push(RAX); }
+						depth++;
+						top.rightPushed = true;
+						next = top.binop->GetRight();
+						break;
+					}
+
+					if (!supported) { break; }
+
+					type = CompileBinop(top.binop, operand);
+					pending.pop_back();
+				}
+
+				if (!supported) { return ValueType::UNIT; }
+				if (!next) { return type; }
+			}
+		}
+
+		//Like vm::CompileStatement, the value is only produced when _keepValue is set
+		ValueType CompileStatement(Statement* _stmt, bool _keepValue)
+		{
+			switch (_stmt->GetID())
+			{
+				case StmtID::EXPR: return CompileExpression((Expression*)_stmt);
+				case StmtID::BLOCK: return CompileBlock((Block*)_stmt, _keepValue);
+				case StmtID::VARDECL:
+				{
+					VarDecl* decl = (VarDecl*)_stmt;
+					ValueType type = CompileExpression(decl->GetExpr());
+
+					if (decl->GetSlot() >= slotTypes.size())
+					{
+						supported = false;
+						return ValueType::UNIT;
+					}
+
+					if (type == ValueType::FLOAT) { as.StoreSD(decl->GetSlot(), 0); }
+					else { as.Store(decl->GetSlot(), RAX); }
+
+					slotTypes[decl->GetSlot()] = type;
+					if (_keepValue) { as.ZeroEax(); }
+					return ValueType::UNIT;
+				}
+			}
+
+			return ValueType::UNIT;
+		}
+
+		//The value of a block is that of its last statement
+		ValueType CompileBlock(Block* _block, bool _keepValue)
+		{
+			auto statements = _block->GetStatements();
+			ValueType type = ValueType::UNIT;
+
+			for (size_t i = 0; i < statements.size; i++)
+			{
+				if (!statements[i])
+				{
+					supported = false;
+					return type;
+				}
+
+				type = CompileStatement(statements[i], _keepValue && i + 1 == statements.size);
+			}
+
+			if (statements.empty() && _keepValue) { as.ZeroEax(); }
+			return type;
+		}
+	public:
+		Compiler(uint32_t _frameSize, ArrayView<const ValueType> _inputTypes) : slotTypes(_frameSize, ValueType::UNIT), depth(0), supported(true)
+		{
+			std::copy(_inputTypes.begin(), _inputTypes.end(), slotTypes.begin());
+		}
+
+		std::unique_ptr<Program> Compile(Block* _block)
+		{
+			//uint32_t entry(uint64_t* slots, uint64_t* result): rbx holds the frame, r12 the result
+			as.Push(RBP);
+			as.Mov(RBP, RSP);
+			as.Push(RBX);
+			as.Push(R12);
+			as.Mov(RBX, RDI);
+			as.Mov(R12, RSI);
+
+			ValueType type = CompileBlock(_block, true);
+			if (!supported) { return nullptr; }
+
+			if (type == ValueType::FLOAT) { as.StoreResultXmm0(); }
+			else { as.StoreResultRax(); }
+
+			//eax is 0 on success, or one more than the index of the error site
+			as.ZeroEax();
+			size_t exit = as.GetOffset();
+			as.RestoreRsp();
+			as.Pop(R12);
+			as.Pop(RBX);
+			as.Pop(RBP);
+			as.Ret();
+
+			for (auto& jump : siteJumps)
+			{
+				as.Patch(jump.first, as.GetOffset());
+				as.MovEax((uint32_t)jump.second + 1);
+				as.Patch(as.Jmp(), exit);
+			}
+
+			auto program = std::make_unique<Program>(as.Finish(), std::move(sites), (uint32_t)slotTypes.size(), type);
+			return program->IsValid() ? std::move(program) : nullptr;
+		}
+	};
+#pragma endregion
+
+#pragma region Program
+	bool IsSupported()
+	{
+#ifdef EDE_JIT
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	Program::Program(const std::vector<uint8_t>& _code, std::vector<ErrorSite> _errorSites, uint32_t _frameSize, ValueType _resultType)
+		: memory(nullptr), size(0), entry(nullptr), errorSites(std::move(_errorSites)), slots(_frameSize), resultType(_resultType)
+	{
+#ifdef EDE_JIT
+		//Written while writable, then flipped to executable; the pages are never both
+		void* mapping = mmap(nullptr, _code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping == MAP_FAILED) { return; }
+
+		memory = mapping;
+		size = _code.size();
+		std::memcpy(memory, _code.data(), size);
+
+		if (mprotect(memory, size, PROT_READ | PROT_EXEC) == 0)
+			entry = (EntryPoint)memory;
+#else
+		(void)_code; //Never built without the JIT, see Compile
+#endif
+	}
+
+	Program::~Program()
+	{
+#ifdef EDE_JIT
+		if (memory) { munmap(memory, size); }
+#endif
+	}
+
+	bool Program::Run(uint64_t* _frame, Result& _result, Diagnostics& _diagnostics) const
+	{
+		uint64_t bits = 0;
+		uint32_t error = entry(_frame, &bits);
+
+		if (error != 0)
+		{
+			const ErrorSite& site = errorSites[error - 1];
+			_diagnostics.Push(GetStatusDiagnostic(site.status), site.position, GetBinopSymbol(site.op));
+			_result = UNIT();
+			return false;
+		}
+
+		switch (resultType)
+		{
+			case ValueType::INT: _result = (INT)bits; break;
+			case ValueType::BOOL: _result = bits != 0; break;
+			case ValueType::FLOAT:
+			{
+				FLOAT value;
+				std::memcpy(&value, &bits, sizeof(value));
+				_result = value;
+			} break;
+			default: _result = UNIT(); break;
+		}
+
+		return true;
+	}
+#pragma endregion
+
+	std::unique_ptr<Program> Compile(Block* _block, uint32_t _frameSize, ArrayView<const ValueType> _inputTypes)
+	{
+		if (!IsSupported() || _inputTypes.size > _frameSize) { return nullptr; }
+
+		Compiler compiler(_frameSize, _inputTypes);
+		return compiler.Compile(_block);
+	}
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Interpreter.h"
+
+using namespace ede::interpreter;
+
+namespace ede::jit
+{
+	//True if native code can be generated here: x86-64 with the System V calling convention (Linux)
+	bool IsSupported();
+
+	//Where compiled code stops with a runtime error; reported exactly like the VM reports it
+	struct ErrorSite
+	{
+		EvalStatus status;
+		Position position;
+		BinopOP op;
+	};
+
+	//Machine code for one block in executable memory. The code itself is immutable, so several threads may run
+	//it at once as long as each passes its own frame; the Run overload without one uses the program's frame.
+	class Program
+	{
+		typedef uint32_t (*EntryPoint)(uint64_t* _slots, uint64_t* _result);
+
+		void* memory;
+		size_t size;
+		EntryPoint entry;
+		std::vector<ErrorSite> errorSites;
+		std::vector<uint64_t> slots; //Raw payloads; the type of every slot is known when compiling
+		ValueType resultType;
+	public:
+		Program(const std::vector<uint8_t>& _code, std::vector<ErrorSite> _errorSites, uint32_t _frameSize, ValueType _resultType);
+		~Program();
+
+		Program(const Program&) = delete;
+		Program& operator=(const Program&) = delete;
+
+		bool IsValid() { return entry != nullptr; }
+		size_t GetCodeSize() { return size; }
+		uint32_t GetFrameSize() const { return (uint32_t)slots.size(); }
+
+		//Same contract as vm::VM::Run: the first runtime error is reported as a diagnostic and the result is UNIT
+		bool Run(Result& _result, Diagnostics& _diagnostics) { return Run(slots.data(), _result, _diagnostics); }
+
+		//Runs on _frame, which holds GetFrameSize() raw payloads; inputs are read from its first slots
+		bool Run(uint64_t* _frame, Result& _result, Diagnostics& _diagnostics) const;
+	};
+
+	//Compiles a resolved and checked block to native code with the semantics of vm::Compile. Returns nullptr
+	//if the platform is not supported or the block uses something the JIT does not handle (Binops the checker
+	//did not type, unresolved identifiers, parse errors, right operands nested more than a few thousand deep);
+	//callers then fall back to the VM.
+	//The first slots hold inputs of _inputTypes, see resolver::Resolve.
+	std::unique_ptr<Program> Compile(Block* _block, uint32_t _frameSize, ArrayView<const ValueType> _inputTypes = ArrayView<const ValueType>());
+};
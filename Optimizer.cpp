@@ -0,0 +1,97 @@
+#include "pch.h"
+#include "Optimizer.h"
+
+namespace ede::optimizer
+{
+	//Returns the replacement of _binop, whose operands have already been folded
+	Expression* FoldBinop(Binop* _binop, Expression* _left, Expression* _right, Arena& _arena, Diagnostics& _diagnostics, size_t& _removed)
+	{
+		_binop->SetLeft(_left);
+		_binop->SetRight(_right);
+
+		if (_left->GetID() != ExprID::LITERAL || _right->GetID() != ExprID::LITERAL)
+			return _binop;
+
+		Value result;
+		EvalStatus status = EvaluateBinop(_binop->GetOP(), ((Literal*)_left)->GetValue(), ((Literal*)_right)->GetValue(), result);
+
+		switch (status)
+		{
+			case EvalStatus::OK:
+			{
+				_removed += 2; //The binop and its two literals become one literal
+				return _arena.New<Literal>(result, _binop->GetPosition());
+			}
+			case EvalStatus::DIVISION_BY_ZERO:
+			case EvalStatus::INTEGER_OVERFLOW:
+			{
+				_diagnostics.Push(GetStatusDiagnostic(status), _binop->GetPosition(), GetBinopSymbol(_binop->GetOP()));
+				return _binop;
+			}
+			default: return _binop; //Operand type errors are left to the evaluator
+		}
+	}
+
+	class Folder
+	{
+		std::vector<Expression*> stack, folded; //Scratch for VisitPostOrder, and the replacements of the operands visited so far
+		Arena& arena;
+		Diagnostics& diagnostics;
+	public:
+		size_t removed;
+
+		Folder(Arena& _arena, Diagnostics& _diagnostics) : arena(_arena), diagnostics(_diagnostics), removed(0) { }
+
+		//A Binop is only rewritten once the walk is done with its operands, so the walk never sees a replaced child
+		Expression* FoldExpression(Expression* _expr)
+		{
+			folded.clear();
+
+			VisitPostOrder(_expr, stack, [&](Expression* _node)
+			{
+				if (_node->GetID() != ExprID::BINOP)
+				{
+					folded.push_back(_node);
+					return true;
+				}
+
+				Expression* right = folded.back();
+				folded.pop_back();
+				folded.back() = FoldBinop((Binop*)_node, folded.back(), right, arena, diagnostics, removed);
+				return true;
+			});
+
+			return folded.back();
+		}
+
+		void FoldStatement(Statement*& _stmt)
+		{
+			switch (_stmt->GetID())
+			{
+				case StmtID::EXPR: _stmt = FoldExpression((Expression*)_stmt); break;
+				case StmtID::VARDECL:
+				{
+					VarDecl* decl = (VarDecl*)_stmt;
+					decl->SetExpr(FoldExpression(decl->GetExpr()));
+				} break;
+				case StmtID::BLOCK:
+				{
+					for (auto& stmt : ((Block*)_stmt)->GetStatements())
+					{
+						if (stmt)
+							FoldStatement(stmt);
+					}
+				} break;
+			}
+		}
+	};
+
+	size_t FoldConstants(Block* _block, Arena& _arena, Diagnostics& _diagnostics)
+	{
+		Folder folder(_arena, _diagnostics);
+		Statement* root = _block;
+
+		folder.FoldStatement(root);
+		return folder.removed;
+	}
+};
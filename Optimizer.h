@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Interpreter.h"
+
+using namespace ede::interpreter;
+
+namespace ede::optimizer
+{
+	//Collapses Binop subtrees whose operands are all literals into a single Literal allocated from _arena.
+	//Folding uses the evaluator's arithmetic; operations that would fail at runtime (division by zero, overflow)
+	//are reported at the Binop's position and left in the tree. Returns the number of nodes removed.
+	size_t FoldConstants(Block* _block, Arena& _arena, Diagnostics& _diagnostics);
+};
@@ -1,5 +1,7 @@
 #include "pch.h"
 #include "Parser.h"
+#include "CharScan.h"
+#include "Stats.h"
 
 namespace ede::parser
 {
@@ -23,22 +25,28 @@ namespace ede::parser
 			case TokenID::SYM_PERCENT: result += "PERCENT"; break;
 			case TokenID::SYM_LPAREN: result += "LPAREN"; break;
 			case TokenID::SYM_RPAREN: result += "RPAREN"; break;
-			case TokenID::IDENTIFIER: result += "ID: " + value; break;
-			case TokenID::LIT_INT: result += "Integer Literal: " + value; break;
-			case TokenID::LIT_FLOAT: result += "Float Literal: " + value; break;
+			case TokenID::SYM_LBRACE: result += "LBRACE"; break;
+			case TokenID::SYM_RBRACE: result += "RBRACE"; break;
+			case TokenID::IDENTIFIER: result += "ID: " + std::string(value); break;
+			case TokenID::LIT_INT: result += "Integer Literal: " + std::string(value); break;
+			case TokenID::LIT_FLOAT: result += "Float Literal: " + std::string(value); break;
 			case TokenID::END_OF_FILE: result += "EOF"; break;
-			case TokenID::INVALID: result += "Invalid: " + value; break;
-			default: result += "Unknown: " + value; break;
+			case TokenID::INVALID: result += "Invalid: " + std::string(value); break;
+			default: result += "Unknown: " + std::string(value); break;
 		}
 
 		return result;
 	}
 
-	int Lexer::Peek() { return stream.peek(); }
-
 	int Lexer::Read()
 	{
-		int result = stream.get();
+		if (cursor == end)
+		{
+			position.column++;
+			return EOF;
+		}
+
+		int result = (unsigned char)*cursor++;
 
 		if (result == '\n')
 		{
@@ -51,326 +59,753 @@ namespace ede::parser
 		return result;
 	}
 
-	std::vector<Token> Tokenize(const std::string& _src, size_t _tabsize)
+	//Keywords and the tokens they produce; adding an entry is all it takes to add a keyword
+	struct Keyword { std::string_view text; TokenID id = TokenID::IDENTIFIER; };
+
+	constexpr Keyword KEYWORDS[] = {
+		{ "let", TokenID::KW_LET }, { "int", TokenID::KW_INT }, { "float", TokenID::KW_FLOAT },
+		{ "bool", TokenID::KW_BOOL }, { "true", TokenID::KW_TRUE }, { "false", TokenID::KW_FALSE },
+	};
+
+	//Perfect hash over the keyword list, keyed on length and the first and last characters
+	constexpr size_t KEYWORD_TABLE_SIZE = 64;
+
+	constexpr size_t HashKeyword(std::string_view _text)
 	{
-		Lexer lexer(_src, _tabsize);
-		std::vector<Token> result;
+		return (_text.size() * 5 + (unsigned char)_text.front() * 3 + (unsigned char)_text.back()) & (KEYWORD_TABLE_SIZE - 1);
+	}
 
-		while (true)
-		{
-			int peeked = lexer.Peek();
+	struct KeywordTable
+	{
+		Keyword slots[KEYWORD_TABLE_SIZE];
+		size_t maxLength;
+		bool perfect;
 
-			while (std::isspace(peeked))
+		constexpr KeywordTable() : slots(), maxLength(0), perfect(true)
+		{
+			for (const Keyword& keyword : KEYWORDS)
 			{
-				lexer.Read();
-				peeked = lexer.Peek();
+				Keyword& slot = slots[HashKeyword(keyword.text)];
+				perfect = perfect && slot.text.empty();
+				slot = keyword;
+				maxLength = std::max(maxLength, keyword.text.size());
 			}
+		}
 
-			switch (peeked)
-			{
-				case ':': { result.push_back(Token(TokenID::SYM_COLON, lexer.GetPosition())); lexer.Read(); } break;
-				case ';': { result.push_back(Token(TokenID::SYM_SEMICOLON, lexer.GetPosition())); lexer.Read(); } break;
-				case '=': { result.push_back(Token(TokenID::SYM_EQUALS, lexer.GetPosition())); lexer.Read(); } break;
-				case '+': { result.push_back(Token(TokenID::SYM_PLUS, lexer.GetPosition())); lexer.Read(); } break;
-				case '-': { result.push_back(Token(TokenID::SYM_MINUS, lexer.GetPosition())); lexer.Read(); } break;
-				case '*': { result.push_back(Token(TokenID::SYM_ASTERISK, lexer.GetPosition())); lexer.Read(); } break;
-				case '/': { result.push_back(Token(TokenID::SYM_FSLASH, lexer.GetPosition())); lexer.Read(); } break;
-				case '%': { result.push_back(Token(TokenID::SYM_PERCENT, lexer.GetPosition())); lexer.Read(); } break;
-				case '(': { result.push_back(Token(TokenID::SYM_LPAREN, lexer.GetPosition())); lexer.Read(); } break;
-				case ')': { result.push_back(Token(TokenID::SYM_RPAREN, lexer.GetPosition())); lexer.Read(); } break;
-				default:
-				{
-					if (std::isalpha(peeked) || peeked == '_') // Identifier or Keyword
-					{
-						std::string value;
-						Position position = lexer.GetPosition();
+		TokenID Find(std::string_view _text) const
+		{
+			if (_text.size() > maxLength) { return TokenID::IDENTIFIER; }
 
-						do
-						{
-							value += lexer.Read();
-							peeked = lexer.Peek();
-						} while (std::isalnum(peeked) || peeked == '_');
-
-						static std::unordered_map<std::string, TokenID> KEYWORDS = {
-							{"let", TokenID::KW_LET }, {"int", TokenID::KW_INT }, {"float", TokenID::KW_FLOAT },
-							{"bool", TokenID::KW_BOOL }, {"true", TokenID::KW_TRUE }, {"flase", TokenID::KW_FALSE }
-						};
-
-						auto keywordSearch = KEYWORDS.find(value);
-						if (keywordSearch != KEYWORDS.end()) { result.push_back(Token(keywordSearch->second, position)); }
-						else { result.push_back(Token(TokenID::IDENTIFIER, position, value)); }
-					}
-					else if (std::isdigit(peeked)) // Numeric Literal
-					{
-						std::string value;
-						Position position = lexer.GetPosition();
-						bool isFloat = false;
+			const Keyword& slot = slots[HashKeyword(_text)];
+			return slot.text == _text ? slot.id : TokenID::IDENTIFIER;
+		}
+	};
 
-						do
-						{
-							value += lexer.Read();
-							peeked = lexer.Peek();
+	constexpr KeywordTable KEYWORD_TABLE;
+	static_assert(KEYWORD_TABLE.perfect, "Keyword hash has a collision; adjust HashKeyword or KEYWORD_TABLE_SIZE");
 
-							if (peeked == '.')
-							{
-								value += lexer.Read();
+	void Lexer::SkipWhitespace()
+	{
+		WhitespaceRun run = ScanWhitespace(cursor, end);
 
-								if (isFloat) { break; }
-								else
-								{
-									peeked = lexer.Peek();
-									isFloat = true;
-								}
-							}
+		//Tabs already count as one column in the run's length
+		if (run.newlines != 0)
+		{
+			position.line += run.newlines;
+			position.column = 1 + (run.end - run.lineStart) + run.tabs * (tabsize - 1);
+		}
+		else { position.column += (run.end - cursor) + run.tabs * (tabsize - 1); }
 
-						} while (std::isdigit(peeked));
+		cursor = run.end;
+	}
 
-						if (value.back() == '.') // Make sure it doesn't end with a dot
-						{
-							PushDiagnostic(DiagnosticType::ERROR_InvalidFloatLit, position, value);
-							result.push_back(Token(TokenID::INVALID, position, value));
-						}
-						else if (isFloat)
-						{
-							try
-							{
-								std::stod(value); //Attempt Conversion
-								result.push_back(Token(TokenID::LIT_FLOAT, position, value));
-							}
-							catch (...)
-							{
-								PushDiagnostic(DiagnosticType::ERROR_FloatLitOutOfRange, position, value);
-								result.push_back(Token(TokenID::INVALID, position, value));
-							}
-						}
-						else
-						{
-							try
-							{
-								std::stoll(value); //Attempt Conversion
-								result.push_back(Token(TokenID::LIT_INT, position, value));
-							}
-							catch (...)
-							{
-								PushDiagnostic(DiagnosticType::ERROR_IntLitOutOfRange, position, value);
-								result.push_back(Token(TokenID::INVALID, position, value));
-							}
-						}
-					}
-					else if (peeked == EOF) // End of File
-					{
-						lexer.Read();
-						result.push_back(Token(TokenID::END_OF_FILE, lexer.GetPosition()));
-						return result;
-					}
-					else // Invalid
-					{
-						result.push_back(Token(TokenID::INVALID, lexer.GetPosition()));
-						lexer.Read();
-					}
-				} break;
+	Token Lexer::Next()
+	{
+		int peeked = Peek();
+
+		if (IsSpace(peeked))
+		{
+			SkipWhitespace();
+			peeked = Peek();
+		}
+
+		Position start = position;
+
+		switch (peeked)
+		{
+			case ':': Skip(1); return Token(TokenID::SYM_COLON, start);
+			case ';': Skip(1); return Token(TokenID::SYM_SEMICOLON, start);
+			case '=': Skip(1); return Token(TokenID::SYM_EQUALS, start);
+			case '+': Skip(1); return Token(TokenID::SYM_PLUS, start);
+			case '-': Skip(1); return Token(TokenID::SYM_MINUS, start);
+			case '*': Skip(1); return Token(TokenID::SYM_ASTERISK, start);
+			case '/': Skip(1); return Token(TokenID::SYM_FSLASH, start);
+			case '%': Skip(1); return Token(TokenID::SYM_PERCENT, start);
+			case '(': Skip(1); return Token(TokenID::SYM_LPAREN, start);
+			case ')': Skip(1); return Token(TokenID::SYM_RPAREN, start);
+			case '{': Skip(1); return Token(TokenID::SYM_LBRACE, start);
+			case '}': Skip(1); return Token(TokenID::SYM_RBRACE, start);
+			default: break;
+		}
+
+		if (IsAlpha(peeked) || peeked == '_') // Identifier or Keyword
+		{
+			const char* current = ScanIdentifier(cursor + 1, end);
+			std::string_view value(cursor, current - cursor);
+			Skip(value.size());
+
+			TokenID keyword = KEYWORD_TABLE.Find(value);
+			if (keyword != TokenID::IDENTIFIER) { return Token(keyword, start); }
+			else { return Token(TokenID::IDENTIFIER, start, value, Intern(value)); }
+		}
+		else if (IsDigit(peeked)) // Numeric Literal
+		{
+			const char* current = ScanDigits(cursor + 1, end);
+			bool isFloat = false;
+
+			if (current != end && *current == '.')
+			{
+				const char* fraction = current + 1;
+				isFloat = true;
+				current = ScanDigits(fraction, end);
+
+				if (current != fraction && current != end && *current == '.') //A second dot after the fraction is consumed as part of the invalid literal
+					current++;
 			}
+
+			std::string_view value(cursor, current - cursor);
+			Skip(value.size());
+
+			if (value.back() == '.') // Make sure it doesn't end with a dot
+			{
+				diagnostics.Push(DiagnosticType::ERROR_InvalidFloatLit, start, value);
+				return Token(TokenID::INVALID, start, value);
+			}
+			else if (isFloat)
+			{
+				Token token(TokenID::LIT_FLOAT, start, value);
+				if (std::from_chars(value.data(), value.data() + value.size(), token.floatValue).ec == std::errc()) { return token; }
+
+				diagnostics.Push(DiagnosticType::ERROR_FloatLitOutOfRange, start, value);
+				return Token(TokenID::INVALID, start, value);
+			}
+			else
+			{
+				Token token(TokenID::LIT_INT, start, value);
+				if (std::from_chars(value.data(), value.data() + value.size(), token.intValue).ec == std::errc()) { return token; }
+
+				diagnostics.Push(DiagnosticType::ERROR_IntLitOutOfRange, start, value);
+				return Token(TokenID::INVALID, start, value);
+			}
+		}
+		else if (peeked == EOF) // End of File
+		{
+			Read();
+			Token token(TokenID::END_OF_FILE, position);
+			position = start; //Stay on the end so every further read yields the same EOF token
+			return token;
+		}
+		else // Invalid
+		{
+			Read();
+			return Token(TokenID::INVALID, start);
 		}
 	}
+
+	std::vector<Token> Tokenize(std::string_view _src, size_t _tabsize, Diagnostics& _diagnostics)
+	{
+		Lexer lexer(_src, _tabsize, _diagnostics);
+		std::vector<Token> result;
+
+		do { result.push_back(lexer.Next()); } while (result.back().id != TokenID::END_OF_FILE);
+
+		EDE_STATS_COUNT(tokens, result.size());
+		return result;
+	}
 #pragma endregion
 
-	class TokenStream
+	Token& TokenStream::Peek()
+	{
+		while (position >= window.size())
+		{
+			window.push_back(lexer.Next());
+			EDE_STATS_COUNT(tokens, 1);
+		}
+
+		return window[position];
+	}
+
+	Token& TokenStream::Read()
+	{
+		Token& token = Peek();
+		position++;
+		return token;
+	}
+
+	void TokenStream::Discard()
 	{
-		std::vector<Token> tokens;
-		size_t position;
-	public:
-		TokenStream(const std::vector<Token> _tokens) : tokens(_tokens), position(0) { }
+		window.erase(window.begin(), window.begin() + position);
+		position = 0;
+	}
 
-		Token& Peek() { return tokens[position]; }
-		Token& Read() { return tokens[position == tokens.size() ? position : position++]; }
-		void Unread() { position = position == 0 ? 0 : (position - 1); }
-		bool IsEOF() { return tokens[position].id == TokenID::END_OF_FILE; }
+	//Builds the pointer tree, allocating every node from an arena
+	struct TreeBuilder
+	{
+		typedef Expression* Expr;
+		typedef VarDecl* Decl;
+		typedef Statement* Stmt;
 
-		size_t GetPosition() { return position; }
+		Arena& arena;
 
-		void Print()
+		template<typename T, typename... Args>
+		T* New(Args&&... _args)
 		{
-			for (auto tok : tokens)
-				std::cout << tok.ToString() << std::endl;
+			EDE_STATS_COUNT(nodes, 1);
+			return arena.New<T>(std::forward<Args>(_args)...);
 		}
+
+		Expr MakeLiteral(Value _value, Position _pos) { return New<Literal>(_value, _pos); }
+		Expr MakeBinop(Expr _left, BinopOP _op, Expr _right, Position _pos) { return New<Binop>(_left, _op, _right, _pos); }
+		Expr MakeIdentifier(Symbol _name, Position _pos) { return New<Identifier>(_name, _pos); }
+		Decl MakeVarDecl(Symbol _varName, Symbol _typeName, Expr _expr, Position _pos) { return New<VarDecl>(_varName, _typeName, _expr, _pos); }
+		Block* MakeBlock(const std::vector<Stmt>& _stmts, Position _pos) { return New<Block>(arena.NewArray(_stmts.data(), _stmts.size()), _pos); }
+
+		Position GetPosition(Stmt _stmt) { return _stmt->GetPosition(); }
+	};
+
+	//Emits nodes straight into the arrays of a FlatTree
+	struct FlatBuilder
+	{
+		typedef NodeRef Expr;
+		typedef NodeRef Decl;
+		typedef NodeRef Stmt;
+
+		FlatTree& tree;
+
+		Expr MakeLiteral(Value _value, Position _pos) { return tree.AddLiteral(_value, _pos); }
+		Expr MakeBinop(Expr _left, BinopOP _op, Expr _right, Position _pos) { return tree.AddBinop(_left, _op, _right, _pos); }
+		Expr MakeIdentifier(Symbol _name, Position _pos) { return tree.AddIdentifier(_name, _pos); }
+		Decl MakeVarDecl(Symbol _varName, Symbol _typeName, Expr _expr, Position _pos) { return tree.AddVarDecl(_varName, _typeName, _expr, _pos); }
+		NodeRef MakeBlock(const std::vector<Stmt>& _stmts, Position _pos) { return tree.AddBlock(_stmts, _pos); }
+
+		Position GetPosition(Stmt _stmt) { return tree.GetPosition(_stmt); }
 	};
 
-	std::string ParseTypeName(TokenStream& _stream)
+	Symbol ParseTypeName(TokenStream& _stream)
 	{
+		static const Symbol INT_SYMBOL = Intern("int"), FLOAT_SYMBOL = Intern("float"), BOOL_SYMBOL = Intern("bool");
+
 		Token& token = _stream.Read();
-		Position start = token.position;
 
 		switch (token.id)
 		{
-			case TokenID::IDENTIFIER: return token.value;
-			case TokenID::KW_INT: return "int";
-			case TokenID::KW_FLOAT: return "float";
+			case TokenID::IDENTIFIER: return token.symbol;
+			case TokenID::KW_INT: return INT_SYMBOL;
+			case TokenID::KW_FLOAT: return FLOAT_SYMBOL;
+			case TokenID::KW_BOOL: return BOOL_SYMBOL;
+			default: break;
 		}
 
-		PushDiagnostic(DiagnosticType::ERROR_ExpectedTypeName, token.position, token.value);
+		_stream.GetDiagnostics().Push(DiagnosticType::ERROR_ExpectedTypeName, token.position, token.value);
 		_stream.Unread();
-		return "";
+		return INVALID_SYMBOL;
 	}
 
-	Expression* ParseExpression(TokenStream& _stream);
+	struct BinopInfo { TokenID token; BinopOP op; size_t precedence; bool leftAssoc; };
 
-	Expression* ParseAtom(TokenStream& _stream)
+	//Binary operators with their precedence and associativity; adding an entry is all it takes to add an operator
+	constexpr BinopInfo BINOPS[] = {
+		{ TokenID::SYM_PLUS, BinopOP::ADD, 0, true }, { TokenID::SYM_MINUS, BinopOP::SUB, 0, true },
+		{ TokenID::SYM_ASTERISK, BinopOP::MUL, 1, true }, { TokenID::SYM_FSLASH, BinopOP::DIV, 1, true }, { TokenID::SYM_PERCENT, BinopOP::MOD, 1, true },
+	};
+
+	//BINOPS indexed by TokenID
+	struct BinopTable
 	{
-		Token& token = _stream.Read();
-		Position start = token.position;
+		static constexpr size_t SIZE = (size_t)TokenID::INVALID + 1;
+		const BinopInfo* entries[SIZE];
 
-		switch (token.id)
+		constexpr BinopTable() : entries()
 		{
-			case TokenID::KW_TRUE: return new Literal(true, start);
-			case TokenID::KW_FALSE: return new Literal(false, start);
-			case TokenID::LIT_INT: return new Literal(std::stoll(token.value), start);
-			case TokenID::LIT_FLOAT: return new Literal(std::stod(token.value), start);
-			case TokenID::SYM_LPAREN:
-			{
-				//Try get unit
-				if (_stream.Peek().id == TokenID::SYM_RPAREN)
-				{
-					_stream.Read();
-					return new Literal(UNIT(), start);
-				}
+			for (const BinopInfo& info : BINOPS)
+				entries[(size_t)info.token] = &info;
+		}
 
-				//Try get parenthesized expression
-				Expression* expr = ParseExpression(_stream);
+		//Returns nullptr if _token is not a binary operator
+		const BinopInfo* Find(TokenID _token) const { return entries[(size_t)_token]; }
+	};
+
+	constexpr BinopTable BINOP_TABLE;
+
+	//Pending work of ParseExpression. Each frame stands for a call of the recursive descent parser it replaces:
+	//PAREN is a parenthesized atom waiting for its expression, EXPRESSION an expression waiting for its first atom,
+	//OPERAND a precedence climbing loop waiting for the atom right of op, and NESTED one waiting for the operators
+	//that bind tighter than op.
+	template<typename Expr>
+	struct ExpressionFrame
+	{
+		enum class Kind : uint8_t { PAREN, EXPRESSION, OPERAND, NESTED };
+
+		Kind kind;
+		Expr left; //Operand left of op
+		size_t leftDepth;
+		const BinopInfo* op;
+		size_t minPrecedence;
+		Position position; //Of the parenthesis or the operator, for diagnostics
+	};
+
+	//Frames ParseExpression holds on to after a deep expression
+	static const size_t MAX_KEPT_FRAMES = 4096;
+
+	//Precedence climbing with an explicit stack, so neither long operator chains nor deep parentheses recurse.
+	//Every value is paired with its depth, which counts operators and parentheses; beyond the limit of the stream
+	//ERROR_NestingTooDeep is reported once, the expression is closed with what was parsed so far and the rest of
+	//the statement is skipped.
+	template<typename Builder>
+	typename Builder::Expr ParseExpression(TokenStream& _stream, Builder& _builder)
+	{
+		typedef typename Builder::Expr Expr;
+		typedef ExpressionFrame<Expr> Frame;
+		enum class Step { ATOM, RETURN, NEXT_OPERATOR, AFTER_OPERAND };
 
-				if (expr)
+		//Kept between calls, most expressions are short and would otherwise pay an allocation each
+		static thread_local std::vector<Frame> frames;
+
+		size_t maxDepth = _stream.GetLimits().maxExpressionDepth, parens = 0;
+		Step step = Step::ATOM;
+		Expr value = Expr();
+		size_t depth = 0;
+		bool tooDeep = false;
+
+		frames.push_back(Frame{ Frame::Kind::EXPRESSION, Expr(), 0, nullptr, 0, Position(0, 0) });
+
+		while (!frames.empty())
+		{
+			Frame& frame = frames.back();
+
+			switch (step)
+			{
+				case Step::ATOM:
 				{
 					Token& token = _stream.Read();
+					Position start = token.position;
+					step = Step::RETURN;
+					depth = 1;
 
-					if (token.id == TokenID::SYM_RPAREN)
-						return expr;
+					switch (token.id)
+					{
+						case TokenID::KW_TRUE: value = _builder.MakeLiteral(true, start); continue;
+						case TokenID::KW_FALSE: value = _builder.MakeLiteral(false, start); continue;
+						case TokenID::LIT_INT: value = _builder.MakeLiteral(token.intValue, start); continue;
+						case TokenID::LIT_FLOAT: value = _builder.MakeLiteral(token.floatValue, start); continue;
+						case TokenID::IDENTIFIER: value = _builder.MakeIdentifier(token.symbol, start); continue;
+						case TokenID::SYM_LPAREN:
+						{
+							//Try get unit
+							if (_stream.Peek().id == TokenID::SYM_RPAREN)
+							{
+								_stream.Read();
+								value = _builder.MakeLiteral(UNIT(), start);
+								continue;
+							}
+
+							if (parens == maxDepth)
+							{
+								_stream.GetDiagnostics().Push(DiagnosticType::ERROR_NestingTooDeep, start, "(");
+								value = _builder.MakeLiteral(UNIT(), start);
+								tooDeep = true;
+								continue;
+							}
 
-					PushDiagnostic(DiagnosticType::ERROR_ExpectedClosingParen, token.position, token.value);
+							//Try get parenthesized expression
+							frames.push_back(Frame{ Frame::Kind::PAREN, Expr(), 0, nullptr, 0, start });
+							frames.push_back(Frame{ Frame::Kind::EXPRESSION, Expr(), 0, nullptr, 0, Position(0, 0) });
+							parens++;
+							step = Step::ATOM;
+						} continue;
+						default: break;
+					}
+
+					_stream.GetDiagnostics().Push(DiagnosticType::ERROR_ExpectedAtom, token.position, token.value);
 					_stream.Unread();
-					return expr;
-				}
-			} break;
-		}
+					value = Expr();
+				} break;
+				case Step::RETURN:
+				{
+					switch (frame.kind)
+					{
+						case Frame::Kind::PAREN:
+						{
+							parens--;
+							depth++;
 
-		PushDiagnostic(DiagnosticType::ERROR_ExpectedAtom, token.position, token.value);
-		_stream.Unread();
-		return nullptr;
-	}
+							if (tooDeep) { }
+							else if (!value)
+							{
+								_stream.GetDiagnostics().Push(DiagnosticType::ERROR_ExpectedAtom, frame.position);
+								_stream.Unread();
+							}
+							else
+							{
+								Token& token = _stream.Read();
 
-	Expression* ParseBinopExpression(TokenStream& _stream, Expression* _lhs, size_t _minPrec)
-	{
-		struct BinopInfo { BinopOP op;  size_t precedence; bool leftAssoc; };
+								if (token.id != TokenID::SYM_RPAREN)
+								{
+									_stream.GetDiagnostics().Push(DiagnosticType::ERROR_ExpectedClosingParen, token.position, token.value);
+									_stream.Unread();
+								}
+							}
 
-		//Map between binary operator symbols and if they are left associative
-		static std::unordered_map<TokenID, BinopInfo> BINOPS = {
-			{ TokenID::SYM_PLUS, { BinopOP::ADD, 0, true } }, { TokenID::SYM_MINUS, { BinopOP::SUB, 0, true } },
-			{ TokenID::SYM_ASTERISK, { BinopOP::MUL, 1, true } }, { TokenID::SYM_FSLASH, { BinopOP::DIV, 1, true }}, { TokenID::SYM_PERCENT, { BinopOP::MOD, 1, true } }
-		};
+							frames.pop_back();
+						} break;
+						case Frame::Kind::EXPRESSION:
+						{
+							if (!value)
+							{
+								frames.pop_back();
+								break;
+							}
 
-		Expression* result = _lhs;
-		auto opSearch = BINOPS.find(_stream.Peek().id);
+							frame = Frame{ Frame::Kind::OPERAND, value, depth, tooDeep ? nullptr : BINOP_TABLE.Find(_stream.Peek().id), 0, Position(0, 0) };
+							step = Step::NEXT_OPERATOR;
+						} break;
+						case Frame::Kind::OPERAND:
+						{
+							if (value)
+							{
+								step = Step::AFTER_OPERAND;
+								break;
+							}
 
-		while (opSearch != BINOPS.end())
-		{
-			BinopInfo initOp = opSearch->second;
-			if (initOp.precedence < _minPrec) { break; }
-			else { _stream.Read(); }
+							//The missing operand has already been reported
+							value = frame.left;
+							depth = frame.leftDepth;
+							frames.pop_back();
+						} break;
+						case Frame::Kind::NESTED: step = Step::AFTER_OPERAND; break;
+					}
+				} break;
+				case Step::NEXT_OPERATOR:
+				{
+					if (!frame.op || frame.op->precedence < frame.minPrecedence)
+					{
+						value = frame.left;
+						depth = frame.leftDepth;
+						frames.pop_back();
+						step = Step::RETURN;
+						break;
+					}
 
-			Expression* rhs = ParseAtom(_stream);
-			opSearch = BINOPS.find(_stream.Peek().id);
+					frame.kind = Frame::Kind::OPERAND;
+					frame.position = _stream.Read().position;
+					step = Step::ATOM;
+				} break;
+				case Step::AFTER_OPERAND:
+				{
+					const BinopInfo* next = tooDeep ? nullptr : BINOP_TABLE.Find(_stream.Peek().id);
 
-			while (opSearch != BINOPS.end())
-			{
-				BinopInfo postOp = opSearch->second;
-				if (postOp.precedence <= initOp.precedence && (postOp.leftAssoc || postOp.precedence != initOp.precedence))
-					break;
+					//Operators that bind tighter than op take value as their left operand first
+					if (next && (next->precedence > frame.op->precedence || (!next->leftAssoc && next->precedence == frame.op->precedence)))
+					{
+						frame.kind = Frame::Kind::NESTED;
+						frames.push_back(Frame{ Frame::Kind::OPERAND, value, depth, next, next->precedence, Position(0, 0) });
+						step = Step::NEXT_OPERATOR;
+						break;
+					}
 
-				rhs = ParseBinopExpression(_stream, rhs, postOp.precedence);
-				opSearch = BINOPS.find(_stream.Peek().id);
-			}
+					frame.left = _builder.MakeBinop(frame.left, frame.op->op, value, _builder.GetPosition(frame.left));
+					frame.leftDepth = std::max(frame.leftDepth, depth) + 1;
 
-			result = new Binop(result, initOp.op, rhs, result->GetPosition());
+					if (frame.leftDepth > maxDepth && !tooDeep)
+					{
+						_stream.GetDiagnostics().Push(DiagnosticType::ERROR_NestingTooDeep, frame.position, GetBinopSymbol(frame.op->op));
+						tooDeep = true;
+						next = nullptr;
+					}
+
+					frame.op = next;
+					step = Step::NEXT_OPERATOR;
+				} break;
+			}
 		}
 
-		return result;
-	}
+		if (frames.capacity() > MAX_KEPT_FRAMES) { std::vector<Frame>().swap(frames); }
 
-	Expression* ParseExpression(TokenStream& _stream)
-	{
-		Expression* atom = ParseAtom(_stream);
-		return atom ? ParseBinopExpression(_stream, atom, 0) : atom;
+		//Resume at the end of the statement
+		if (tooDeep)
+		{
+			while (!_stream.IsEOF() && _stream.Peek().id != TokenID::SYM_SEMICOLON && _stream.Peek().id != TokenID::SYM_RBRACE)
+				_stream.Read();
+		}
+
+		return value;
 	}
 
-	VarDecl* ParseVarDecl(TokenStream& _stream)
+	template<typename Builder>
+	typename Builder::Decl ParseVarDecl(TokenStream& _stream, Builder& _builder)
 	{
 		Token& peeked = _stream.Peek();
-		if (peeked.id != TokenID::KW_LET) { return nullptr; }
+		if (peeked.id != TokenID::KW_LET) { return typename Builder::Decl(); }
 		else { _stream.Read(); }
 
 		Position start = peeked.position;
-		std::string varName;
+		Symbol varName;
 		peeked = _stream.Peek();
 		if (peeked.id != TokenID::IDENTIFIER)
 		{
-			PushDiagnostic(DiagnosticType::ERROR_ExpectedIdentifier, peeked.position, peeked.value);
-			return nullptr;
+			_stream.GetDiagnostics().Push(DiagnosticType::ERROR_ExpectedIdentifier, peeked.position, peeked.value);
+			return typename Builder::Decl();
 		}
-		else { varName = _stream.Read().value; }
+		else { varName = _stream.Read().symbol; }
 
 		peeked = _stream.Peek();
 		if (peeked.id != TokenID::SYM_COLON)
 		{
-			PushDiagnostic(DiagnosticType::ERROR_ExpectedColon, peeked.position, peeked.value);
-			return nullptr;
+			_stream.GetDiagnostics().Push(DiagnosticType::ERROR_ExpectedColon, peeked.position, peeked.value);
+			return typename Builder::Decl();
 		}
 		else { _stream.Read(); }
 
-		std::string typeName = ParseTypeName(_stream);
-		if (typeName.empty()) { return nullptr; }
+		Symbol typeName = ParseTypeName(_stream);
+		if (typeName == INVALID_SYMBOL) { return typename Builder::Decl(); }
 
 		peeked = _stream.Peek();
 		if (peeked.id != TokenID::SYM_EQUALS)
 		{
-			PushDiagnostic(DiagnosticType::ERROR_ExpectedEquals, peeked.position, peeked.value);
-			return nullptr;
+			_stream.GetDiagnostics().Push(DiagnosticType::ERROR_ExpectedEquals, peeked.position, peeked.value);
+			return typename Builder::Decl();
 		}
 		else { _stream.Read(); }
 
-		Expression* expr = ParseExpression(_stream);
+		typename Builder::Expr expr = ParseExpression(_stream, _builder);
 		if (!expr)
 		{
-			PushDiagnostic(DiagnosticType::ERROR_ExpectedExpr, _stream.Peek().position, _stream.Peek().value);
-			return nullptr;
+			_stream.GetDiagnostics().Push(DiagnosticType::ERROR_ExpectedExpr, _stream.Peek().position, _stream.Peek().value);
+			return typename Builder::Decl();
+		}
+		else { return _builder.MakeVarDecl(varName, typeName, expr, start); }
+	}
+
+	template<typename Builder>
+	typename Builder::Stmt ParseStatement(TokenStream& _stream, Builder& _builder);
+
+	//Parses statements up to, but not including, _terminator or the end of the file
+	template<typename Builder>
+	std::vector<typename Builder::Stmt> ParseStatements(TokenStream& _stream, Builder& _builder, TokenID _terminator)
+	{
+		std::vector<typename Builder::Stmt> statements;
+
+		while (!_stream.IsEOF() && _stream.Peek().id != _terminator)
+		{
+			_stream.Discard();
+			statements.push_back(ParseStatement(_stream, _builder));
 		}
-		else { return new VarDecl(varName, typeName, expr, start); }
+
+		return statements;
 	}
 
-	Statement* ParseStatement(TokenStream& _stream)
+	template<typename Builder>
+	typename Builder::Stmt ParseStatement(TokenStream& _stream, Builder& _builder)
 	{
-		Statement* result = nullptr;
+		typename Builder::Stmt result = typename Builder::Stmt();
 		Token& start = _stream.Peek();
 
-		if ((result = ParseVarDecl(_stream)) || (result = ParseExpression(_stream)))
+		if (start.id == TokenID::SYM_LBRACE && _stream.GetBlockDepth() >= _stream.GetLimits().maxBlockDepth)
+		{
+			_stream.GetDiagnostics().Push(DiagnosticType::ERROR_NestingTooDeep, start.position, "{");
+
+			//Skip the whole block, it is left out of the tree
+			for (size_t open = 0; !_stream.IsEOF();)
+			{
+				TokenID id = _stream.Read().id;
+				if (id == TokenID::SYM_LBRACE) { open++; }
+				else if (id == TokenID::SYM_RBRACE && --open == 0) { break; }
+			}
+		}
+		else if (start.id == TokenID::SYM_LBRACE) //Nested block
+		{
+			Position position = _stream.Read().position;
+			_stream.EnterBlock();
+			auto statements = ParseStatements(_stream, _builder, TokenID::SYM_RBRACE);
+			_stream.LeaveBlock();
+
+			Token& token = _stream.Read();
+			if (token.id != TokenID::SYM_RBRACE)
+			{
+				_stream.GetDiagnostics().Push(DiagnosticType::ERROR_ExpectedClosingBrace, token.position, token.value);
+				_stream.Unread();
+			}
+
+			return _builder.MakeBlock(statements, position);
+		}
+		else if ((result = ParseVarDecl(_stream, _builder)) || (result = ParseExpression(_stream, _builder)))
 		{
 			Token& token = _stream.Read();
 			if (token.id != TokenID::SYM_SEMICOLON)
 			{
-				PushDiagnostic(DiagnosticType::ERROR_ExpectedSemicolon, token.position, token.value);
+				_stream.GetDiagnostics().Push(DiagnosticType::ERROR_ExpectedSemicolon, token.position, token.value);
 				_stream.Unread();
 			}
 		}
-		else { PushDiagnostic(DiagnosticType::ERROR_ExpectedStmt, start.position, start.value); }
+		else
+		{
+			_stream.GetDiagnostics().Push(DiagnosticType::ERROR_ExpectedStmt, start.position, start.value);
+			_stream.Read(); //Skip the offending token so parsing always makes progress
+		}
 
 		return result;
 	}
 
-	Node* Parse(const std::string& _src, size_t _tabsize)
+	template<typename Builder>
+	auto ParseBlock(TokenStream& _stream, Builder& _builder)
+	{
+		auto statements = ParseStatements(_stream, _builder, TokenID::END_OF_FILE);
+		Position position = (!statements.empty() && statements.front()) ? _builder.GetPosition(statements.front()) : Position(1, 1);
+		return _builder.MakeBlock(statements, position);
+	}
+
+	Statement* Parser::ParseStatement()
+	{
+		TreeBuilder builder{ arena };
+		stream.Discard();
+		return parser::ParseStatement(stream, builder);
+	}
+
+	Block* Parse(std::string_view _src, size_t _tabsize, Arena& _arena, Diagnostics& _diagnostics, const Limits& _limits)
+	{
+		TokenStream stream(_src, _tabsize, _diagnostics, Position(1, 1), _limits);
+		TreeBuilder builder{ _arena };
+		return ParseBlock(stream, builder);
+	}
+
+	FlatTree ParseFlat(std::string_view _src, size_t _tabsize, Diagnostics& _diagnostics, const Limits& _limits)
+	{
+		TokenStream stream(_src, _tabsize, _diagnostics, Position(1, 1), _limits);
+		FlatTree tree;
+		FlatBuilder builder{ tree };
+
+		tree.SetRoot(ParseBlock(stream, builder));
+		return tree;
+	}
+
+	//Start of a slice of the source that begins at a top-level statement
+	struct SourceSlice
+	{
+		size_t offset;
+		Position position;
+	};
+
+	//Cuts _src after semicolons outside parentheses and braces, at least _minSize bytes apart.
+	//The language has no strings or comments, so every ';' byte is a semicolon token.
+	std::vector<SourceSlice> SliceSource(std::string_view _src, size_t _tabsize, size_t _minSize)
+	{
+		std::vector<SourceSlice> slices{ SourceSlice{ 0, Position(1, 1) } };
+		size_t line = 1, lineStart = 0, tabs = 0;
+		int depth = 0;
+
+		for (size_t i = 0; i < _src.size(); i++)
+		{
+			switch (_src[i])
+			{
+				case '\n': line++; lineStart = i + 1; tabs = 0; break;
+				case '\t': tabs++; break;
+				case '(': case '{': depth++; break;
+				case ')': case '}': depth--; break;
+				case ';':
+				{
+					if (depth == 0 && i + 1 - slices.back().offset >= _minSize && i + 1 < _src.size())
+						slices.push_back(SourceSlice{ i + 1, Position(line, 1 + (i + 1 - lineStart) + tabs * (_tabsize - 1)) });
+				} break;
+			}
+		}
+
+		return slices;
+	}
+
+	Block* ParseParallel(std::string_view _src, size_t _tabsize, Arena& _arena, Diagnostics& _diagnostics, size_t _jobs, const Limits& _limits)
 	{
-		TokenStream stream(Tokenize(_src, _tabsize));
+		static const size_t MIN_SLICE_SIZE = 64 * 1024;
+
+		size_t jobs = _jobs != 0 ? _jobs : std::max<size_t>(1, std::thread::hardware_concurrency());
+		size_t sliceSize = std::max(MIN_SLICE_SIZE, _src.size() / (jobs * 4)); //A few slices per worker to even out the load
+
+		if (jobs == 1 || _src.size() < sliceSize * 2)
+			return Parse(_src, _tabsize, _arena, _diagnostics, _limits);
+
+		struct Piece
+		{
+			Arena arena;
+			std::vector<Statement*> statements;
+#ifndef EDE_NO_STATS
+			stats::Counters counters; //Only counted into the caller's when the piece is kept
+#endif
+			bool clean = false;
+		};
+
+		std::vector<SourceSlice> slices = SliceSource(_src, _tabsize, sliceSize);
+		std::vector<Piece> pieces(slices.size());
+		std::atomic<size_t> next(0), firstDirty(slices.size());
+#ifndef EDE_NO_STATS
+		stats::Counters* counters = stats::current;
+#endif
+
+		auto worker = [&]()
+		{
+			for (size_t i = next++; i < slices.size(); i = next++)
+			{
+				if (i > firstDirty) { continue; } //Reparsed sequentially anyway
+
+				EDE_STATS_SCOPE(counters ? &pieces[i].counters : nullptr);
+				size_t end = i + 1 < slices.size() ? slices[i + 1].offset : _src.size();
+				Diagnostics diagnostics;
+				TokenStream stream(_src.substr(slices[i].offset, end - slices[i].offset), _tabsize, diagnostics, slices[i].position, _limits);
+				TreeBuilder builder{ pieces[i].arena };
+
+				pieces[i].statements = ParseStatements(stream, builder, TokenID::END_OF_FILE);
+				pieces[i].clean = diagnostics.GetCount() == 0;
+
+				if (!pieces[i].clean)
+				{
+					size_t dirty = firstDirty;
+					while (i < dirty && !firstDirty.compare_exchange_weak(dirty, i)) { }
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+
+		for (size_t i = 1; i < std::min(jobs, slices.size()); i++)
+			threads.emplace_back(worker);
+
+		worker();
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		//Pieces before the first error start and end on statement boundaries of the sequential parse
 		std::vector<Statement*> statements;
+		size_t i = 0;
+
+		for (; i < pieces.size() && pieces[i].clean; i++)
+		{
+			statements.insert(statements.end(), pieces[i].statements.begin(), pieces[i].statements.end());
+			_arena.Adopt(pieces[i].arena);
+#ifndef EDE_NO_STATS
+			if (counters) { counters->Add(pieces[i].counters); }
+#endif
+		}
+
+		TreeBuilder builder{ _arena };
 
-		while (!stream.IsEOF())
-			statements.push_back(ParseStatement(stream));
+		//From the first error on, recovery may cross slice boundaries, so the rest is parsed like Parse would
+		if (i < pieces.size())
+		{
+			TokenStream stream(_src.substr(slices[i].offset), _tabsize, _diagnostics, slices[i].position, _limits);
+			auto rest = ParseStatements(stream, builder, TokenID::END_OF_FILE);
+			statements.insert(statements.end(), rest.begin(), rest.end());
+		}
 
-		return new Block(statements, (!statements.empty() && statements.front()) ? statements.front()->GetPosition() : Position(1, 1));
+		Position position = (!statements.empty() && statements.front()) ? statements.front()->GetPosition() : Position(1, 1);
+		return builder.MakeBlock(statements, position);
 	}
 }
@@ -1,6 +1,7 @@
 #pragma once
 
-#include "AST.h"
+#include "ast.h"
+#include "FlatAST.h"
 
 using namespace ede::ast;
 
@@ -11,7 +12,7 @@ namespace ede::parser
 		KW_LET, KW_INT, KW_FLOAT, KW_BOOL, KW_TRUE, KW_FALSE,
 		SYM_COLON, SYM_SEMICOLON, SYM_EQUALS,
 		SYM_PLUS, SYM_MINUS, SYM_ASTERISK, SYM_FSLASH, SYM_PERCENT,
-		SYM_LPAREN, SYM_RPAREN,
+		SYM_LPAREN, SYM_RPAREN, SYM_LBRACE, SYM_RBRACE,
 		IDENTIFIER, LIT_INT, LIT_FLOAT,
 
 		END_OF_FILE, INVALID
@@ -21,27 +22,113 @@ namespace ede::parser
 	{
 		TokenID id;
 		Position position;
-		std::string value;
+		std::string_view value; //Source text of identifiers, literals and invalid tokens
 
-		Token(TokenID _id, Position _pos, std::string _val = "") : id(_id), position(_pos), value(_val) { }
+		//Payload, selected by id
+		union
+		{
+			Symbol symbol; //IDENTIFIER
+			INT intValue; //LIT_INT
+			FLOAT floatValue; //LIT_FLOAT
+		};
+
+		Token(TokenID _id, Position _pos, std::string_view _val = std::string_view(), Symbol _symbol = INVALID_SYMBOL) : id(_id), position(_pos), value(_val), symbol(_symbol) { }
 
 		std::string ToString();
 	};
 
 	class Lexer
 	{
-		std::stringstream stream;
+		const char* cursor, * end;
 		Position position;
 		size_t tabsize;
+		Diagnostics& diagnostics;
 	public:
-		Lexer(const std::string& _src, size_t _tabsize) : stream(_src), position(1, 1), tabsize(_tabsize) { }
+		//_start is the position of the first character, for lexing a slice of a larger file
+		Lexer(std::string_view _src, size_t _tabsize, Diagnostics& _diagnostics, Position _start = Position(1, 1)) : cursor(_src.data()), end(_src.data() + _src.size()), position(_start), tabsize(_tabsize), diagnostics(_diagnostics) { }
+
+		Token Next();
+		void SkipWhitespace();
 
-		int Peek();
+		int Peek() { return cursor == end ? EOF : (unsigned char)*cursor; }
 		int Read();
 
+		//Advances over _count characters that are known not to contain newlines or tabs
+		void Skip(size_t _count) { cursor += _count; position.column += _count; }
+
+		const char* GetCursor() { return cursor; }
+		const char* GetEnd() { return end; }
 		Position GetPosition() { return position; }
+		Diagnostics& GetDiagnostics() { return diagnostics; }
+	};
+
+	//Bounds on the nesting the parser accepts; deeper input is reported as ERROR_NestingTooDeep and skipped.
+	//Expressions are parsed and walked by every pass without recursion, so their limit only bounds memory.
+	//Blocks are still walked recursively, so theirs keeps every pass well within the stack of a worker thread.
+	struct Limits
+	{
+		size_t maxExpressionDepth = 1 << 20; //Operators and parentheses nested in one expression
+		size_t maxBlockDepth = 1000; //Blocks nested in the top-level block
+	};
+
+	//Pulls tokens from a lexer on demand, buffering only the tokens of the statement being parsed
+	class TokenStream
+	{
+		Lexer lexer;
+		std::deque<Token> window;
+		size_t position;
+		Limits limits;
+		size_t blockDepth;
+	public:
+		TokenStream(std::string_view _src, size_t _tabsize, Diagnostics& _diagnostics, Position _start = Position(1, 1), const Limits& _limits = Limits())
+			: lexer(_src, _tabsize, _diagnostics, _start), window(), position(0), limits(_limits), blockDepth(0) { }
+
+		Token& Peek();
+		Token& Read();
+		void Unread() { position = position == 0 ? 0 : (position - 1); }
+		bool IsEOF() { return Peek().id == TokenID::END_OF_FILE; }
+		Diagnostics& GetDiagnostics() { return lexer.GetDiagnostics(); }
+		Lexer& GetLexer() { return lexer; }
+
+		//True if nothing has been looked ahead at, so the lexer sits right after the last token read
+		bool IsDrained() { return position == window.size(); }
+
+		//Drops every token before the current one; references to them are invalidated
+		void Discard();
+
+		const Limits& GetLimits() { return limits; }
+
+		//Blocks open around the statement being parsed
+		size_t GetBlockDepth() { return blockDepth; }
+		void EnterBlock() { blockDepth++; }
+		void LeaveBlock() { blockDepth--; }
 	};
 
-	std::vector<Token> Tokenize(const std::string& _src, size_t _tabsize);
-	Node* Parse(const std::string& _src, size_t _tabsize);
+	//Parses one top-level statement at a time so a file can be consumed before it is fully lexed
+	class Parser
+	{
+		TokenStream stream;
+		Arena& arena;
+	public:
+		Parser(std::string_view _src, size_t _tabsize, Arena& _arena, Diagnostics& _diagnostics, Position _start = Position(1, 1), const Limits& _limits = Limits())
+			: stream(_src, _tabsize, _diagnostics, _start, _limits), arena(_arena) { }
+
+		Statement* ParseStatement();
+		bool IsEOF() { return stream.IsEOF(); }
+
+		//Parsing can resume from a fresh Parser at GetCursor and GetPosition whenever the last statement ended drained
+		bool IsDrained() { return stream.IsDrained(); }
+		const char* GetCursor() { return stream.GetLexer().GetCursor(); }
+		Position GetPosition() { return stream.GetLexer().GetPosition(); }
+	};
+
+	//Errors are reported to _diagnostics, whose messages refer to spans of _src
+	std::vector<Token> Tokenize(std::string_view _src, size_t _tabsize, Diagnostics& _diagnostics);
+	Block* Parse(std::string_view _src, size_t _tabsize, Arena& _arena, Diagnostics& _diagnostics, const Limits& _limits = Limits());
+	FlatTree ParseFlat(std::string_view _src, size_t _tabsize, Diagnostics& _diagnostics, const Limits& _limits = Limits());
+
+	//Same result as Parse, but the file is cut at top-level semicolons and the pieces are parsed on _jobs threads
+	//(0 for one per core). Pieces that report an error are parsed again sequentially from their start, so
+	//positions, error recovery and the order of diagnostics are exactly those of Parse. Small files are parsed in place.
+	Block* ParseParallel(std::string_view _src, size_t _tabsize, Arena& _arena, Diagnostics& _diagnostics, size_t _jobs = 0, const Limits& _limits = Limits());
 };
\ No newline at end of file
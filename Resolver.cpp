@@ -0,0 +1,142 @@
+#include "pch.h"
+#include "Resolver.h"
+
+namespace ede::resolver
+{
+	class Resolver
+	{
+		struct Binding { Symbol name; VarDecl* hidden; };
+		struct Scope { Block* block; size_t current, firstBinding; };
+
+		std::unordered_map<Symbol, VarDecl*> visible;
+		std::vector<Binding> bindings; //Index of a binding is its slot
+		std::vector<Scope> scopes;
+		std::vector<Expression*> stack; //Scratch for VisitPostOrder
+		Diagnostics& diagnostics;
+		uint32_t frameSize;
+		bool success;
+
+		//Returns true if _name is declared later in one of the open scopes
+		bool IsDeclaredLater(Symbol _name)
+		{
+			for (const Scope& scope : scopes)
+			{
+				auto statements = scope.block->GetStatements();
+
+				for (size_t i = scope.current; i < statements.size; i++)
+				{
+					Statement* stmt = statements[i];
+					if (stmt && stmt->GetID() == StmtID::VARDECL && ((VarDecl*)stmt)->GetVarName() == _name)
+						return true;
+				}
+			}
+
+			return false;
+		}
+
+		void Declare(VarDecl* _decl)
+		{
+			Symbol name = _decl->GetVarName();
+			auto search = visible.find(name);
+			VarDecl* hidden = search == visible.end() ? nullptr : search->second;
+
+			if (hidden)
+			{
+				diagnostics.Push(DiagnosticType::ERROR_Shadowing, _decl->GetPosition(), GetSymbolText(name));
+				success = false;
+			}
+
+			_decl->SetSlot((uint32_t)bindings.size());
+			bindings.push_back(Binding{ name, hidden });
+			visible[name] = _decl;
+			frameSize = std::max(frameSize, (uint32_t)bindings.size());
+		}
+
+		void ResolveIdentifier(Identifier* _identifier)
+		{
+			auto search = visible.find(_identifier->GetName());
+
+			if (search != visible.end())
+			{
+				_identifier->SetDecl(search->second);
+				return;
+			}
+
+			_identifier->SetDecl(nullptr); //The tree may have been resolved before, see parser::Document
+			DiagnosticType type = IsDeclaredLater(_identifier->GetName()) ? DiagnosticType::ERROR_UseBeforeDeclaration : DiagnosticType::ERROR_UndeclaredIdentifier;
+			diagnostics.Push(type, _identifier->GetPosition(), GetSymbolText(_identifier->GetName()));
+			success = false;
+		}
+
+		void ResolveExpression(Expression* _expr)
+		{
+			VisitPostOrder(_expr, stack, [&](Expression* _node)
+			{
+				if (_node->GetID() == ExprID::IDENTIFIER) { ResolveIdentifier((Identifier*)_node); }
+				return true;
+			});
+		}
+
+		void ResolveBlock(Block* _block)
+		{
+			auto statements = _block->GetStatements();
+			scopes.push_back(Scope{ _block, 0, bindings.size() });
+
+			for (size_t i = 0; i < statements.size; i++)
+			{
+				scopes.back().current = i;
+				if (statements[i]) { ResolveStatement(statements[i]); }
+			}
+
+			//Close the scope, making its slots available again
+			for (size_t i = bindings.size(); i > scopes.back().firstBinding; i--)
+			{
+				const Binding& binding = bindings[i - 1];
+
+				if (binding.hidden) { visible[binding.name] = binding.hidden; }
+				else { visible.erase(binding.name); }
+			}
+
+			bindings.resize(scopes.back().firstBinding);
+			scopes.pop_back();
+		}
+
+		void ResolveStatement(Statement* _stmt)
+		{
+			switch (_stmt->GetID())
+			{
+				case StmtID::EXPR: ResolveExpression((Expression*)_stmt); break;
+				case StmtID::VARDECL:
+				{
+					VarDecl* decl = (VarDecl*)_stmt;
+					ResolveExpression(decl->GetExpr()); //The binding is not visible in its own initializer
+					Declare(decl);
+				} break;
+				case StmtID::BLOCK: ResolveBlock((Block*)_stmt); break;
+			}
+		}
+	public:
+		Resolver(Diagnostics& _diagnostics) : diagnostics(_diagnostics), frameSize(0), success(true) { }
+
+		bool Run(Block* _block, ArrayView<VarDecl* const> _predeclared, uint32_t& _frameSize)
+		{
+			for (VarDecl* decl : _predeclared)
+				Declare(decl);
+
+			ResolveBlock(_block);
+			_frameSize = frameSize;
+			return success;
+		}
+	};
+
+	bool Resolve(Block* _block, uint32_t& _frameSize, Diagnostics& _diagnostics)
+	{
+		return Resolve(_block, ArrayView<VarDecl* const>(), _frameSize, _diagnostics);
+	}
+
+	bool Resolve(Block* _block, ArrayView<VarDecl* const> _predeclared, uint32_t& _frameSize, Diagnostics& _diagnostics)
+	{
+		Resolver resolver(_diagnostics);
+		return resolver.Run(_block, _predeclared, _frameSize);
+	}
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "ast.h"
+
+using namespace ede::ast;
+
+namespace ede::resolver
+{
+	//Links every identifier to its declaration and gives every let binding a slot in a flat frame.
+	//Scopes follow Block nesting; the slots of a scope are reused once it closes, so _frameSize is the
+	//largest number of bindings alive at once. Shadowing, redeclaration and references to undeclared
+	//or not yet declared variables are reported as diagnostics. Returns false if an error was reported.
+	bool Resolve(Block* _block, uint32_t& _frameSize, Diagnostics& _diagnostics);
+
+	//Same as Resolve, but the _predeclared bindings are visible throughout the block and take slots 0 to
+	//_predeclared.size - 1, in order, so a host can store values into them before running it
+	bool Resolve(Block* _block, ArrayView<VarDecl* const> _predeclared, uint32_t& _frameSize, Diagnostics& _diagnostics);
+};
@@ -0,0 +1,495 @@
+#include "pch.h"
+#include "Serializer.h"
+#include "Stats.h"
+
+namespace ede::serializer
+{
+	//File layout: Header, then the name table (varint length and bytes per name), then the tree in preorder.
+	//Every node starts with a byte holding its tag in the low nibble and its line as a delta from the previous node
+	//in the high one; LINE_ESCAPE means the delta follows as a zigzag varint. The column follows as a varint.
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		SourceKey source;
+		uint32_t nameCount, reserved;
+	};
+
+	static const char MAGIC[4] = { 'E', 'D', 'E', 'T' };
+
+	//Binop tags follow the order of BinopOP
+	enum class Tag : uint8_t
+	{
+		NONE, BLOCK, VARDECL, IDENTIFIER,
+		LIT_UNIT, LIT_INT, LIT_FLOAT, LIT_TRUE, LIT_FALSE,
+		BINOP_ADD, BINOP_SUB, BINOP_MUL, BINOP_DIV, BINOP_MOD
+	};
+
+	static const uint8_t LINE_ESCAPE = 15;
+
+	SourceKey HashSource(std::string_view _src)
+	{
+		static const uint64_t K = 0x9E3779B97F4A7C15ull, P1 = 0xC2B2AE3D27D4EB4Full, P2 = 0x165667B19E3779F9ull;
+
+		size_t size = _src.size(), i = 0;
+		SourceKey key{ size, size * K, size ^ P2 };
+		if (size == 0) { return key; } //data() may be null
+
+		const char* data = _src.data();
+		uint64_t word;
+
+		//hash xors each word in and multiplies, check adds it multiplied and rotates, so one colliding does not make the other
+		for (; i + 8 <= size; i += 8)
+		{
+			std::memcpy(&word, data + i, 8);
+			key.hash = (key.hash ^ word) * K;
+			key.hash ^= key.hash >> 29;
+			key.check += word * P1;
+			key.check = ((key.check << 31) | (key.check >> 33)) * P2;
+		}
+
+		word = 0;
+		std::memcpy(&word, data + i, size - i);
+		key.hash = (key.hash ^ word) * K;
+		key.hash ^= key.hash >> 32;
+		key.check += word * P1;
+		key.check = ((key.check << 31) | (key.check >> 33)) * P2;
+		key.check = (key.check ^ (key.check >> 33)) * P1;
+		key.check ^= key.check >> 29;
+		return key;
+	}
+
+#pragma region Encoder
+	class Encoder
+	{
+		std::string output;
+		std::vector<Symbol> names;
+		std::unordered_map<Symbol, uint32_t> nameIndices;
+		std::vector<Expression*> stack; //Operands still to write
+		size_t line;
+
+		void WriteVarint(uint64_t _value)
+		{
+			for (; _value >= 0x80; _value >>= 7) { output.push_back((char)(_value | 0x80)); }
+			output.push_back((char)_value);
+		}
+
+		//Index 0 stands for INVALID_SYMBOL, which the parser never leaves in a tree; the decoder rejects it
+		void WriteName(Symbol _name)
+		{
+			if (_name == INVALID_SYMBOL) { WriteVarint(0); return; }
+
+			auto result = nameIndices.emplace(_name, (uint32_t)names.size() + 1);
+			if (result.second) { names.push_back(_name); }
+			WriteVarint(result.first->second);
+		}
+
+		void WriteNode(Tag _tag, Position _pos)
+		{
+			int64_t delta = (int64_t)_pos.line - (int64_t)line;
+			line = _pos.line;
+
+			if (delta >= 0 && delta < LINE_ESCAPE) { output.push_back((char)((uint8_t)_tag | (uint8_t)(delta << 4))); }
+			else
+			{
+				output.push_back((char)((uint8_t)_tag | (LINE_ESCAPE << 4)));
+				WriteVarint(((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+			}
+
+			WriteVarint(_pos.column);
+		}
+	public:
+		Encoder() : line(1) { }
+
+		void WriteStatement(Statement* _stmt)
+		{
+			if (!_stmt)
+			{
+				output.push_back((char)Tag::NONE);
+				return;
+			}
+
+			switch (_stmt->GetID())
+			{
+				case StmtID::BLOCK:
+				{
+					auto statements = ((Block*)_stmt)->GetStatements();
+					WriteNode(Tag::BLOCK, _stmt->GetPosition());
+					WriteVarint(statements.size);
+
+					for (Statement* stmt : statements)
+						WriteStatement(stmt);
+				} break;
+				case StmtID::VARDECL:
+				{
+					VarDecl* decl = (VarDecl*)_stmt;
+					WriteNode(Tag::VARDECL, decl->GetPosition());
+					WriteName(decl->GetVarName());
+					WriteName(decl->GetTypeName());
+					WriteStatement(decl->GetExpr());
+				} break;
+				case StmtID::EXPR: WriteExpression((Expression*)_stmt); break;
+			}
+		}
+
+		//Binops are written in preorder from an explicit stack, so deep trees do not recurse
+		void WriteExpression(Expression* _expr)
+		{
+			size_t base = stack.size();
+			stack.push_back(_expr);
+
+			while (stack.size() != base)
+			{
+				Expression* expr = stack.back();
+				stack.pop_back();
+
+				if (!expr) { output.push_back((char)Tag::NONE); }
+				else if (expr->GetID() != ExprID::BINOP) { WriteLeaf(expr); }
+				else
+				{
+					Binop* binop = (Binop*)expr;
+					WriteNode((Tag)((uint8_t)Tag::BINOP_ADD + (uint8_t)binop->GetOP()), binop->GetPosition());
+					stack.push_back(binop->GetRight());
+					stack.push_back(binop->GetLeft());
+				}
+			}
+		}
+
+		void WriteLeaf(Expression* _expr)
+		{
+			switch (_expr->GetID())
+			{
+				case ExprID::IDENTIFIER:
+				{
+					WriteNode(Tag::IDENTIFIER, _expr->GetPosition());
+					WriteName(((Identifier*)_expr)->GetName());
+				} break;
+				case ExprID::LITERAL:
+				{
+					const Value& value = ((Literal*)_expr)->GetValue();
+
+					switch (value.GetType())
+					{
+						case ValueType::UNIT: WriteNode(Tag::LIT_UNIT, _expr->GetPosition()); break;
+						case ValueType::BOOL: WriteNode(value.AsBool() ? Tag::LIT_TRUE : Tag::LIT_FALSE, _expr->GetPosition()); break;
+						case ValueType::INT:
+						{
+							WriteNode(Tag::LIT_INT, _expr->GetPosition());
+							WriteVarint(((uint64_t)value.AsInt() << 1) ^ (uint64_t)(value.AsInt() >> 63));
+						} break;
+						case ValueType::FLOAT:
+						{
+							uint64_t bits = value.GetBits();
+							WriteNode(Tag::LIT_FLOAT, _expr->GetPosition());
+							output.append((const char*)&bits, sizeof(bits));
+						} break;
+					}
+				} break;
+				default: break; //Binops are written by WriteExpression and never reach a leaf
+			}
+		}
+
+		std::string Finish(const SourceKey& _source)
+		{
+			Header header{ { MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3] }, FORMAT_VERSION, _source, (uint32_t)names.size(), 0 };
+			std::string tree;
+
+			//The name table goes before the tree but is only complete once the tree is written
+			tree.swap(output);
+			output.assign((const char*)&header, sizeof(header));
+
+			for (Symbol name : names)
+			{
+				std::string_view text = GetSymbolText(name);
+				WriteVarint(text.size());
+				output.append(text);
+			}
+
+			output.append(tree);
+			return std::move(output);
+		}
+	};
+#pragma endregion
+
+#pragma region Decoder
+	class Decoder
+	{
+		const char* cursor, * end;
+		Arena& arena;
+		std::vector<Symbol> names;
+		std::vector<Statement*> scratch; //Children of the blocks being decoded
+
+		struct PendingBinop { Tag tag; Position position; Expression* left; bool hasLeft; };
+		std::vector<PendingBinop> pending;
+		size_t line;
+		size_t blockDepth, maxBlockDepth; //Blocks open around the node being decoded
+		bool failed;
+
+		uint64_t ReadVarint()
+		{
+			uint64_t result = 0;
+
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				if (cursor == end) { break; }
+
+				uint8_t byte = (uint8_t)*cursor++;
+				result |= (uint64_t)(byte & 0x7F) << shift;
+				if (!(byte & 0x80)) { return result; }
+			}
+
+			failed = true;
+			return 0;
+		}
+
+		Symbol ReadName()
+		{
+			uint64_t index = ReadVarint();
+			if (index != 0 && index <= names.size()) { return names[index - 1]; }
+
+			failed = true;
+			return INVALID_SYMBOL;
+		}
+
+		Position ReadPosition(uint8_t _lineDelta)
+		{
+			if (_lineDelta == LINE_ESCAPE)
+			{
+				uint64_t delta = ReadVarint();
+				line += (size_t)((delta >> 1) ^ (~(delta & 1) + 1));
+			}
+			else { line += _lineDelta; }
+
+			return Position(line, (size_t)ReadVarint());
+		}
+	public:
+		Decoder(std::string_view _data, Arena& _arena, size_t _maxBlockDepth)
+			: cursor(_data.data()), end(_data.data() + _data.size()), arena(_arena), line(1), blockDepth(0), maxBlockDepth(_maxBlockDepth), failed(false) { }
+
+		bool ReadNames(uint32_t _count)
+		{
+			if (_count > (uint64_t)(end - cursor)) { return false; } //Every name takes at least a byte
+			names.reserve(_count);
+
+			for (uint32_t i = 0; i < _count && !failed; i++)
+			{
+				uint64_t size = ReadVarint();
+				if (size > (uint64_t)(end - cursor)) { return false; }
+
+				names.push_back(Intern(std::string_view(cursor, (size_t)size)));
+				cursor += size;
+			}
+
+			return !failed;
+		}
+
+		//Returns nullptr for NONE, in which case failed tells whether that was an error. NONE is only valid in a block,
+		//where it stands for a statement that failed to parse; blocks recurse, up to maxBlockDepth deep like the parser.
+		Statement* ReadStatement()
+		{
+			if (cursor == end || failed)
+			{
+				failed = true;
+				return nullptr;
+			}
+
+			uint8_t head = (uint8_t)*cursor++;
+			Tag tag = (Tag)(head & 0xF);
+			if (head == (uint8_t)Tag::NONE) { return nullptr; }
+
+			EDE_STATS_COUNT(nodes, 1);
+
+			Position position = ReadPosition(head >> 4);
+
+			switch (tag)
+			{
+				case Tag::BLOCK:
+				{
+					uint64_t count = ReadVarint();
+					if (count > (uint64_t)(end - cursor)) { break; } //Every statement takes at least a byte
+
+					//Counts the root too, which the parser does not, hence the > rather than >=
+					if (blockDepth > maxBlockDepth) { break; }
+					blockDepth++;
+
+					size_t first = scratch.size();
+
+					for (uint64_t i = 0; i < count && !failed; i++)
+					{
+						scratch.push_back(ReadStatement());
+					}
+
+					blockDepth--;
+					ArrayView<Statement*> statements = arena.NewArray(scratch.data() + first, scratch.size() - first);
+					scratch.resize(first);
+					return arena.New<Block>(statements, position);
+				}
+				case Tag::VARDECL:
+				{
+					Symbol varName = ReadName(), typeName = ReadName();
+					return arena.New<VarDecl>(varName, typeName, ReadExpression(), position);
+				}
+				case Tag::BINOP_ADD: case Tag::BINOP_SUB: case Tag::BINOP_MUL: case Tag::BINOP_DIV: case Tag::BINOP_MOD: return ReadBinop(tag, position);
+				case Tag::IDENTIFIER: return arena.New<Identifier>(ReadName(), position);
+				case Tag::LIT_UNIT: return arena.New<Literal>(Value(UNIT()), position);
+				case Tag::LIT_TRUE: return arena.New<Literal>(Value(true), position);
+				case Tag::LIT_FALSE: return arena.New<Literal>(Value(false), position);
+				case Tag::LIT_INT:
+				{
+					uint64_t zigzag = ReadVarint();
+					return arena.New<Literal>(Value((INT)((zigzag >> 1) ^ (~(zigzag & 1) + 1))), position);
+				}
+				case Tag::LIT_FLOAT:
+				{
+					FLOAT value;
+					if (end - cursor < (ptrdiff_t)sizeof(value)) { break; }
+
+					std::memcpy(&value, cursor, sizeof(value));
+					cursor += sizeof(value);
+					return arena.New<Literal>(Value(value), position);
+				}
+				default: break;
+			}
+
+			failed = true;
+			return nullptr;
+		}
+
+		//Fails on anything but an expression, checking the tag first so a block here is never decoded
+		Expression* ReadExpression()
+		{
+			Tag tag = cursor != end ? (Tag)(*cursor & 0xF) : Tag::NONE;
+
+			if (tag < Tag::IDENTIFIER || tag > Tag::BINOP_MOD)
+			{
+				failed = true;
+				return nullptr;
+			}
+
+			return (Expression*)ReadStatement();
+		}
+
+		//Called once the tag and position of a Binop are read. Operands that are Binops themselves are read in the same
+		//loop, with the Binops still missing an operand kept in pending, so deep trees do not recurse.
+		Expression* ReadBinop(Tag _tag, Position _position)
+		{
+			size_t base = pending.size();
+			pending.push_back(PendingBinop{ _tag, _position, nullptr, false });
+
+			for (;;)
+			{
+				uint8_t head = cursor != end && !failed ? (uint8_t)*cursor : (uint8_t)Tag::NONE;
+				Tag tag = (Tag)(head & 0xF);
+
+				if (tag >= Tag::BINOP_ADD && tag <= Tag::BINOP_MOD)
+				{
+					cursor++;
+					EDE_STATS_COUNT(nodes, 1);
+
+					Position position = ReadPosition(head >> 4);
+					pending.push_back(PendingBinop{ tag, position, nullptr, false });
+					continue;
+				}
+
+				Expression* operand = ReadExpression();
+
+				//Complete the Binops that now have both operands, the last one completed is an operand of the one below
+				for (;;)
+				{
+					PendingBinop& top = pending.back();
+
+					if (!top.hasLeft)
+					{
+						top.left = operand;
+						top.hasLeft = true;
+						break;
+					}
+
+					operand = arena.New<Binop>(top.left, (BinopOP)((uint8_t)top.tag - (uint8_t)Tag::BINOP_ADD), operand, top.position);
+					pending.pop_back();
+
+					if (pending.size() == base) { return operand; }
+				}
+			}
+		}
+
+		bool IsComplete() { return !failed && cursor == end; }
+	};
+#pragma endregion
+
+	std::string EncodeTree(Block* _block, const SourceKey& _source)
+	{
+		Encoder encoder;
+		encoder.WriteStatement(_block);
+		return encoder.Finish(_source);
+	}
+
+	Block* DecodeTree(std::string_view _data, const SourceKey& _source, Arena& _arena, const parser::Limits& _limits)
+	{
+		Header header;
+		if (_data.size() < sizeof(header)) { return nullptr; }
+
+		std::memcpy(&header, _data.data(), sizeof(header));
+		if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != FORMAT_VERSION)
+			return nullptr;
+
+		if (header.source.size != _source.size || header.source.hash != _source.hash || header.source.check != _source.check)
+			return nullptr;
+
+		Decoder decoder(_data.substr(sizeof(header)), _arena, _limits.maxBlockDepth);
+		if (!decoder.ReadNames(header.nameCount)) { return nullptr; }
+
+		Statement* root = decoder.ReadStatement();
+		return decoder.IsComplete() && root && root->GetID() == StmtID::BLOCK ? (Block*)root : nullptr;
+	}
+
+	Cache::Cache(const std::string& _directory) : directory(_directory), hits(0), misses(0), stores(0)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+	}
+
+	std::filesystem::path Cache::GetPath(const SourceKey& _source)
+	{
+		char name[64];
+		std::snprintf(name, sizeof(name), "%016llx.v%u.ast", (unsigned long long)_source.hash, FORMAT_VERSION);
+		return directory / name;
+	}
+
+	//Sources whose hashes collide share a file, which then holds the tree of the last one stored and is a miss for the other
+	Block* Cache::Load(std::string_view _src, Arena& _arena, const parser::Limits& _limits)
+	{
+		SourceKey key = HashSource(_src);
+		MappedFile file(GetPath(key).string());
+		Block* block = file.IsOpen() ? DecodeTree(file.GetView(), key, _arena, _limits) : nullptr;
+
+		if (block) { hits++; }
+		else { misses++; }
+
+		return block;
+	}
+
+	void Cache::Store(std::string_view _src, Block* _block)
+	{
+		SourceKey key = HashSource(_src);
+		std::string data = EncodeTree(_block, key);
+		std::filesystem::path path = GetPath(key);
+
+		//Written under a name of its own and renamed, so concurrent readers never see a partial file
+		std::ostringstream suffix;
+		suffix << ".tmp" << std::this_thread::get_id();
+		std::filesystem::path temporary = path;
+		temporary += suffix.str();
+
+		{
+			std::ofstream file(temporary, std::ios::binary);
+			if (!file.write(data.data(), data.size())) { return; }
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporary, path, error);
+
+		if (error) { std::filesystem::remove(temporary, error); }
+		else { stores++; }
+	}
+};
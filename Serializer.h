@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ast.h"
+#include "Parser.h"
+
+using namespace ede::ast;
+
+namespace ede::serializer
+{
+	//Version of the binary tree format; bump whenever the encoding or the meaning of a tree changes
+	static const uint32_t FORMAT_VERSION = 1;
+
+	//Identifies the content of a source file: its size and two independent 64-bit hashes of it, hash naming the cache
+	//file and check guarding against a collision of hash alone. Not collision resistant against crafted input.
+	struct SourceKey
+	{
+		uint64_t size, hash, check;
+	};
+
+	//Fast, one pass over _src for both hashes
+	SourceKey HashSource(std::string_view _src);
+
+	//Encodes _block and everything below it, with positions and a table of the names it uses.
+	//_source is stored in the header so a tree is never loaded for another source.
+	std::string EncodeTree(Block* _block, const SourceKey& _source);
+
+	//Rebuilds a tree written by EncodeTree in _arena, without touching the source. Returns nullptr if _data is
+	//truncated or corrupt, was written by another format version or does not belong to the source with the key _source.
+	//Trees the parser could not have built, such as a declaration without a name or blocks nested deeper than
+	//_limits allows, count as corrupt.
+	Block* DecodeTree(std::string_view _data, const SourceKey& _source, Arena& _arena, const parser::Limits& _limits = parser::Limits());
+
+	//Directory of encoded trees keyed by source content and format version. Safe to share between threads.
+	class Cache
+	{
+		std::filesystem::path directory;
+		std::atomic<size_t> hits, misses, stores;
+
+		std::filesystem::path GetPath(const SourceKey& _source);
+	public:
+		Cache(const std::string& _directory);
+
+		//Returns the cached tree of _src, allocated from _arena, or nullptr if there is none or it breaks _limits
+		Block* Load(std::string_view _src, Arena& _arena, const parser::Limits& _limits = parser::Limits());
+
+		//Stores the tree of _src; only trees parsed without errors should be stored. Failures are ignored.
+		void Store(std::string_view _src, Block* _block);
+
+		size_t GetHits() { return hits; }
+		size_t GetMisses() { return misses; }
+		size_t GetStores() { return stores; }
+	};
+};
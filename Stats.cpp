@@ -0,0 +1,78 @@
+#include "pch.h"
+#include "Stats.h"
+
+namespace ede::stats
+{
+	thread_local Counters* current = nullptr;
+
+	std::string_view GetPhaseName(Phase _phase)
+	{
+		switch (_phase)
+		{
+			case Phase::READ: return "read";
+			case Phase::PARSE: return "parse";
+			case Phase::FOLD: return "fold";
+			case Phase::RESOLVE: return "resolve";
+			case Phase::CHECK: return "check";
+			case Phase::RUN: return "run";
+			case Phase::PRINT: return "print";
+			default: return "teardown";
+		}
+	}
+
+	void Counters::Add(const Counters& _other)
+	{
+		for (size_t i = 0; i < (size_t)Phase::COUNT; i++)
+			seconds[i] += _other.seconds[i];
+
+		files += _other.files;
+		bytes += _other.bytes;
+		tokens += _other.tokens;
+		nodes += _other.nodes;
+		diagnostics += _other.diagnostics;
+		allocations += _other.allocations;
+		bytesAllocated += _other.bytesAllocated;
+		peakTreeBytes = std::max(peakTreeBytes, _other.peakTreeBytes);
+	}
+
+	void PrintText(const Counters& _counters, double _wall, std::ostream& _stream)
+	{
+		double total = 0;
+
+		for (double seconds : _counters.seconds)
+			total += seconds;
+
+		char line[128];
+		_stream << "Stats:" << std::endl;
+
+		for (size_t i = 0; i < (size_t)Phase::COUNT; i++)
+		{
+			double share = total > 0 ? _counters.seconds[i] / total * 100 : 0;
+			std::snprintf(line, sizeof(line), "  %-10s %12.3f ms %6.1f%%", GetPhaseName((Phase)i).data(), _counters.seconds[i] * 1000, share);
+			_stream << line << std::endl;
+		}
+
+		std::snprintf(line, sizeof(line), "  %-10s %12.3f ms (%.3f ms wall)", "total", total * 1000, _wall * 1000);
+		_stream << line << std::endl;
+		_stream << "  " << _counters.files << " files, " << _counters.bytes << " bytes, " << _counters.tokens << " tokens, " << _counters.nodes << " nodes, "
+			<< _counters.diagnostics << " diagnostics" << std::endl;
+		_stream << "  " << _counters.bytesAllocated << " bytes allocated in " << _counters.allocations << " allocations, largest tree "
+			<< _counters.peakTreeBytes << " bytes" << std::endl;
+	}
+
+	void PrintJson(const Counters& _counters, double _wall, std::ostream& _stream)
+	{
+		std::ostringstream json;
+		json.precision(9);
+		json << "{ \"wallSeconds\": " << _wall << ", \"phases\": { ";
+
+		for (size_t i = 0; i < (size_t)Phase::COUNT; i++)
+			json << (i ? ", \"" : "\"") << GetPhaseName((Phase)i) << "\": " << _counters.seconds[i];
+
+		json << " }, \"files\": " << _counters.files << ", \"bytes\": " << _counters.bytes << ", \"tokens\": " << _counters.tokens
+			<< ", \"nodes\": " << _counters.nodes << ", \"diagnostics\": " << _counters.diagnostics << ", \"allocations\": " << _counters.allocations
+			<< ", \"bytesAllocated\": " << _counters.bytesAllocated << ", \"peakTreeBytes\": " << _counters.peakTreeBytes << " }";
+
+		_stream << json.str() << std::endl;
+	}
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+//Pipeline instrumentation. Every hook goes through the EDE_STATS_* macros below, so a build with EDE_NO_STATS
+//defined contains none of it; otherwise a hook costs a thread-local load and a branch when nobody collects.
+
+namespace ede::stats
+{
+	enum class Phase : uint8_t
+	{
+		READ, //Opening and mapping the file
+		PARSE, //Lexing, which the parser drives one token at a time, parsing, and the cache
+		FOLD,
+		RESOLVE,
+		CHECK,
+		RUN, //Compiling to bytecode or native code and running
+		PRINT, //Dumping the tree and formatting the result and diagnostics
+		TEARDOWN, //Releasing the tree
+		COUNT
+	};
+
+	std::string_view GetPhaseName(Phase _phase);
+
+	struct Counters
+	{
+		double seconds[(size_t)Phase::COUNT] = {};
+		size_t files = 0, bytes = 0;
+		size_t tokens = 0, nodes = 0, diagnostics = 0;
+		size_t allocations = 0, bytesAllocated = 0;
+		size_t peakTreeBytes = 0; //Arena memory held by the largest tree
+
+		//Sums everything but the peak, which is the larger of the two
+		void Add(const Counters& _other);
+	};
+
+	//Counters the calling thread reports to, nullptr when not collecting
+	extern thread_local Counters* current;
+
+	//Makes _counters the current counters of the calling thread until the end of the scope
+	class Scope
+	{
+		Counters* previous;
+	public:
+		Scope(Counters* _counters) : previous(current) { current = _counters; }
+		~Scope() { current = previous; }
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+	//Charges the time since the previous lap, or since construction, to a phase of the current counters.
+	//The clock is never read while nobody collects.
+	class Stopwatch
+	{
+		std::chrono::steady_clock::time_point last;
+	public:
+		Stopwatch() { if (current) { last = std::chrono::steady_clock::now(); } }
+
+		void Lap(Phase _phase)
+		{
+			if (!current) { return; }
+
+			auto now = std::chrono::steady_clock::now();
+			current->seconds[(size_t)_phase] += std::chrono::duration<double>(now - last).count();
+			last = now;
+		}
+	};
+
+	//_wall is the elapsed time of the whole run, which differs from the sum of the phases when files compile in parallel
+	void PrintText(const Counters& _counters, double _wall, std::ostream& _stream);
+	void PrintJson(const Counters& _counters, double _wall, std::ostream& _stream);
+};
+
+#ifdef EDE_NO_STATS
+#define EDE_STATS_SCOPE(_counters) ((void)0)
+#define EDE_STATS_STOPWATCH(_name) ((void)0)
+#define EDE_STATS_LAP(_name, _phase) ((void)0)
+#define EDE_STATS_COUNT(_field, _amount) ((void)0)
+#else
+#define EDE_STATS_SCOPE(_counters) ede::stats::Scope statsScope(_counters)
+#define EDE_STATS_STOPWATCH(_name) ede::stats::Stopwatch _name
+#define EDE_STATS_LAP(_name, _phase) _name.Lap(ede::stats::Phase::_phase)
+#define EDE_STATS_COUNT(_field, _amount) do { if (ede::stats::current) { ede::stats::current->_field += (_amount); } } while (0)
+#endif
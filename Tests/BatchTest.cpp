@@ -0,0 +1,154 @@
+#include "pch.h"
+#include "Test.h"
+#include "Engine.h"
+
+using namespace ede;
+using namespace ede::test;
+
+//Runs every program over columns with RunBatch and row by row on the VM, and requires every row to get the same value
+//bit for bit up to NaN payloads, or the same first error. Columns are longer than a chunk and full of extremes, zeros, NaNs and infinities.
+static const std::vector<ProgramInput> INPUTS = { { "a", false }, { "b", false }, { "x", true }, { "y", true } };
+
+static const char* const SOURCES[] = {
+	"a + b;", "a - b;", "a * b;", "a / b;", "a % b;",
+	"x + y;", "x - y;", "x * y;", "x / y;", "x % y;",
+	"a;", "x;", "flag;", "1;", "let c : int = a;",
+	"a + 9223372036854775807;", "(0 - 9223372036854775807 - 1) / b;", "a % (0 - 1);",
+	"let c : int = a / b; let d : int = c * c; d % a;", //The first of several errors is reported
+	"(a - b) + (a * b) / (b - 1) % (a + 1);",
+	"{ let c : float = x * 2.5; { c / y; } }",
+};
+
+static const size_t ROWS = 2 * batch::Evaluator::CHUNK_SIZE + 37;
+
+static std::vector<INT> MakeIntColumn(Random& _random)
+{
+	static const INT SPECIAL[] = { 0, 0, 1, -1, 2, -2, 7, -7, LLONG_MAX, LLONG_MIN, LLONG_MAX - 1, LLONG_MIN + 1 };
+	std::vector<INT> column(ROWS);
+
+	for (INT& value : column)
+	{
+		if (_random.Chance(50)) { value = SPECIAL[_random.Range(0, std::size(SPECIAL) - 1)]; }
+		else { value = (INT)(_random.Next() >> _random.Range(0, 62)) * (_random.Chance(50) ? 1 : -1); }
+	}
+
+	return column;
+}
+
+static std::vector<FLOAT> MakeFloatColumn(Random& _random)
+{
+	static const FLOAT SPECIAL[] = { 0.0, -0.0, 1.0, -1.0, 0.5, 1e308, -1e308, 5e-324,
+		std::numeric_limits<FLOAT>::infinity(), -std::numeric_limits<FLOAT>::infinity(), std::numeric_limits<FLOAT>::quiet_NaN() };
+	std::vector<FLOAT> column(ROWS);
+
+	for (FLOAT& value : column)
+	{
+		if (_random.Chance(40)) { value = SPECIAL[_random.Range(0, std::size(SPECIAL) - 1)]; }
+		else { value = (FLOAT)(INT)(_random.Next() >> 40) / 1024.0 * (_random.Chance(50) ? 1 : -1); }
+	}
+
+	return column;
+}
+
+struct Columns
+{
+	std::vector<INT> a, b;
+	std::vector<FLOAT> x, y;
+	std::unique_ptr<BOOL[]> flag;
+
+	Columns(Random& _random) : a(MakeIntColumn(_random)), b(MakeIntColumn(_random)), x(MakeFloatColumn(_random)), y(MakeFloatColumn(_random)), flag(new BOOL[ROWS])
+	{
+		for (size_t row = 0; row < ROWS; row++)
+			flag[row] = _random.Chance(50);
+	}
+};
+
+//Bit for bit, except that any NaN equals any other: IEEE 754 leaves open which operand's NaN an operation passes on,
+//and compilers are free to swap the operands of + and *
+static bool SameValue(const Value& _a, const Value& _b)
+{
+	if (_a.GetType() != _b.GetType()) { return false; }
+	if (_a.IsFloat() && std::isnan(_a.AsFloat())) { return std::isnan(_b.AsFloat()); }
+	return _a.GetBits() == _b.GetBits();
+}
+
+static void TestProgram(const engine::Engine& _engine, bool _fold, const std::string& _source, const Columns& _columns, const std::string& _label)
+{
+	Diagnostics diagnostics;
+	std::shared_ptr<const engine::Program> program = _engine.Compile(_source, diagnostics);
+
+	//Folding reports the runtime errors it finds ahead of time, which leaves nothing to run
+	if (_fold && !program) { return; }
+	if (!Expect(program != nullptr, _label + ": does not compile\n" + _source + PrintDiagnostics(diagnostics))) { return; }
+
+	const batch::Column columns[] = { _columns.a.data(), _columns.b.data(), _columns.x.data(), _columns.y.data(), _columns.flag.get() };
+	engine::Context context;
+	batch::Output output;
+	Diagnostics batchDiagnostics(ROWS); //Room for an error in every row
+	bool success = program->RunBatch(ArrayView<const batch::Column>(columns, std::size(columns)), ROWS, context, output, batchDiagnostics);
+
+	std::string rowDiagnostics;
+	size_t error = 0, mismatches = 0;
+
+	for (size_t row = 0; row < ROWS && mismatches < 5; row++)
+	{
+		const Value inputs[] = { _columns.a[row], _columns.b[row], _columns.x[row], _columns.y[row], _columns.flag[row] };
+		Diagnostics vmDiagnostics;
+		interpreter::Result value;
+		bool vmSuccess = program->Run(ArrayView<const Value>(inputs, std::size(inputs)), context, value, vmDiagnostics);
+		std::string vmErrors = PrintDiagnostics(vmDiagnostics);
+		rowDiagnostics += vmErrors;
+
+		//Errors are listed by row, a row failed if it is the next one listed
+		bool failed = error < output.errors.size() && output.errors[error].row == row;
+		std::string batch;
+
+		if (failed)
+		{
+			const batch::RowError& rowError = output.errors[error++];
+			Diagnostics errorDiagnostics;
+			errorDiagnostics.Push(GetStatusDiagnostic(rowError.status), rowError.position, GetBinopSymbol(rowError.op));
+			batch = PrintDiagnostics(errorDiagnostics);
+		}
+		else { batch = output.GetValue(row).ToString(); }
+
+		bool same = failed ? !vmSuccess && batch == vmErrors : vmSuccess && SameValue(output.GetValue(row), value);
+
+		if (!Expect(same, _label + ", row " + std::to_string(row) + ": the batch gave " + batch + " and the VM " + (vmSuccess ? value.ToString() : vmErrors) + "\n" + _source))
+			mismatches++;
+	}
+
+	if (mismatches != 0) { return; }
+
+	Expect(error == output.errors.size(), _label + ": the batch reported errors past the last row");
+	Expect(success == output.errors.empty(), _label + ": RunBatch returned " + (success ? "true" : "false"));
+	Expect(PrintDiagnostics(batchDiagnostics) == rowDiagnostics, _label + ": the diagnostics differ from those of the rows in order\n" + _source);
+}
+
+int main()
+{
+	Random random(21);
+	Columns columns(random);
+
+	for (bool fold : { false, true })
+	{
+		engine::Options options;
+		options.fold = fold;
+		options.jit = false;
+		engine::Engine engine(options);
+
+		for (const ProgramInput& input : INPUTS)
+			engine.DeclareInput(input.name, input.isFloat ? ValueType::FLOAT : ValueType::INT);
+
+		engine.DeclareInput("flag", ValueType::BOOL);
+		std::string mode = fold ? "folded " : "";
+
+		for (size_t i = 0; i < std::size(SOURCES); i++)
+			TestProgram(engine, fold, SOURCES[i], columns, mode + "source " + std::to_string(i));
+
+		for (size_t i = 0; i < 150; i++)
+			TestProgram(engine, fold, GenerateProgram(random, INPUTS), columns, mode + "program " + std::to_string(i));
+	}
+
+	return Finish("BatchTest");
+}
@@ -0,0 +1,105 @@
+#include "pch.h"
+#include "Test.h"
+#include "Document.h"
+#include "Resolver.h"
+#include "Checker.h"
+#include "Bytecode.h"
+
+using namespace ede;
+using namespace ede::test;
+
+//Applies random edits to documents and compares each updated tree with a fresh parse of the same text: the nodes
+//and their positions, the parse errors, and what resolving, checking and running the two trees report
+static const char* const SOURCES[] = {
+	"",
+	"let a : int = 1;\na + 2;\n",
+	"let a : int = ;\n1 +;\n{ let b : float = 1.5; b * 2.0;\n", //Parse errors, and a block left open
+	"{ { let x : int = 1; } }\n\tlet y : int = x;\n",
+};
+
+//Pieces of programs, so edits often keep the text parseable and often do not
+static const char* const FRAGMENTS[] = {
+	"", "", "let ", "let v : int = 1;\n", "x", "a", " : int = ", " : float = ", "1", "1.5", "9223372036854775807",
+	";", ";\n", "{", "}", "{ }", "(", ")", " + ", " * ", " / 0", " % ", "\n", "\t", "  ", "@", "true", "/",
+};
+
+//What a pass over a tree reports, with the value of running it when nothing was
+static std::string Analyze(Block* _block)
+{
+	Diagnostics diagnostics;
+	uint32_t frameSize = 0;
+
+	resolver::Resolve(_block, frameSize, diagnostics);
+	checker::Check(_block, diagnostics);
+	std::string report = PrintDiagnostics(diagnostics);
+
+	if (diagnostics.GetCount() == 0)
+	{
+		vm::VM vm;
+		interpreter::Result result;
+		if (vm.Run(vm::Compile(_block, frameSize), result, diagnostics)) { report += "Result: " + result.ToString(); }
+		else { report += PrintDiagnostics(diagnostics); }
+	}
+
+	return report;
+}
+
+static std::string MakeEdit(Random& _random, const std::string& _source)
+{
+	std::string text = FRAGMENTS[_random.Range(0, std::size(FRAGMENTS) - 1)];
+
+	//Sometimes a piece of the document itself, as when moving code around
+	if (_random.Chance(15) && !_source.empty())
+	{
+		size_t start = (size_t)_random.Range(0, _source.size() - 1);
+		text = _source.substr(start, (size_t)_random.Range(1, 40));
+	}
+
+	return text;
+}
+
+static void TestEdits(const std::string& _source, Random& _random, size_t _edits, const std::string& _label)
+{
+	parser::Document document(_source, 4);
+
+	for (size_t i = 0; i < _edits; i++)
+	{
+		const std::string& source = document.GetSource();
+		size_t offset = (size_t)_random.Range(0, source.size());
+		size_t length = (size_t)_random.Range(0, std::min<size_t>(source.size() - offset, _random.Chance(10) ? 200 : 8));
+		std::string text = MakeEdit(_random, source);
+		std::string edit = _label + ", edit " + std::to_string(i) + " replacing " + std::to_string(length) + " bytes at " + std::to_string(offset);
+
+		Block* root = document.Edit(offset, length, text);
+		Diagnostics diagnostics;
+		document.ReportDiagnostics(diagnostics);
+
+		Arena arena;
+		Diagnostics expectedDiagnostics;
+		Block* expected = parser::Parse(document.GetSource(), 4, arena, expectedDiagnostics);
+
+		//The description has every position, which the shifted statements must get right
+		bool same = Expect(DescribeTree(root) == DescribeTree(expected), edit + ": the tree differs from Parse");
+		same = Expect(PrintDiagnostics(diagnostics) == PrintDiagnostics(expectedDiagnostics), edit + ": the parse errors differ from Parse") && same;
+		same = Expect(Analyze(root) == Analyze(expected), edit + ": resolving, checking or running differs from the tree of Parse") && same;
+
+		if (!same)
+		{
+			std::cerr << "Text after the edit:\n" << document.GetSource() << std::endl;
+			return;
+		}
+	}
+}
+
+int main()
+{
+	Random random(17);
+
+	for (size_t i = 0; i < std::size(SOURCES); i++)
+		TestEdits(SOURCES[i], random, 200, "source " + std::to_string(i));
+
+	for (size_t i = 0; i < 200; i++)
+		TestEdits(GenerateProgram(random), random, 100, "program " + std::to_string(i));
+
+	return Finish("DocumentTest");
+}
@@ -0,0 +1,363 @@
+#include "pch.h"
+#include "Test.h"
+#include "Parser.h"
+#include "Dump.h"
+
+using namespace ede;
+using namespace ede::test;
+
+//Requires the TREE dump of every tree to be the text of Node::ToString, and the JSON dump to be valid JSON that gives
+//back every name and value, including non-finite floats as strings and names that need escaping.
+static const char* const SOURCES[] = {
+	"1;",
+	"let x : int = 1 + 2 * 3; x;",
+	"let f : float = 2.5; { let g : float = f / 0.1; { g - 1e300; } }",
+	"let a : int = 9223372036854775807; let b : int = 0 - a - 1; a % b;",
+	"{ } { { } } 0.1 + 0.2;",
+	"let x : int = ; x + ;", //Statements that fail to parse are left out of the tree
+	"@ 1; { 2 + ; } 3;",
+};
+
+static std::string DumpText(Block* _block, dump::Format _format)
+{
+	std::ostringstream text;
+	dump::Writer writer(text);
+	dump::Dump(_block, _format, writer);
+	writer.Flush();
+	return text.str();
+}
+
+static std::string DumpText(const FlatTree& _tree, dump::Format _format)
+{
+	std::ostringstream text;
+	dump::Writer writer(text);
+	dump::Dump(_tree, _format, writer);
+	writer.Flush();
+	return text.str();
+}
+
+#pragma region JSON
+//Just enough of a JSON reader to check the grammar of RFC 8259 and read values back. It recurses, the trees here are shallow.
+struct Json
+{
+	enum class Kind : uint8_t { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT } kind = Kind::NUL;
+	std::string text; //The decoded string, or the number as written
+	std::vector<std::pair<std::string, Json>> members;
+	std::vector<Json> items;
+
+	const Json* Find(std::string_view _key) const
+	{
+		for (const auto& member : members)
+		{
+			if (member.first == _key) { return &member.second; }
+		}
+
+		return nullptr;
+	}
+};
+
+class JsonReader
+{
+	std::string_view text;
+	size_t at;
+
+	bool Fail() { at = std::string_view::npos; return false; }
+	bool Failed() { return at == std::string_view::npos; }
+	char Peek() { return at < text.size() ? text[at] : '\0'; }
+
+	bool Literal(std::string_view _word)
+	{
+		if (text.substr(at, _word.size()) != _word) { return Fail(); }
+		at += _word.size();
+		return true;
+	}
+
+	bool Digits()
+	{
+		size_t start = at;
+		while (std::isdigit((unsigned char)Peek())) { at++; }
+		return at != start || Fail();
+	}
+
+	bool Number(Json& _value)
+	{
+		size_t start = at;
+		if (Peek() == '-') { at++; }
+		if (Peek() == '0') { at++; }
+		else if (!Digits()) { return false; }
+		if (Peek() == '.') { at++; if (!Digits()) { return false; } }
+
+		if (Peek() == 'e' || Peek() == 'E')
+		{
+			at++;
+			if (Peek() == '+' || Peek() == '-') { at++; }
+			if (!Digits()) { return false; }
+		}
+
+		_value.kind = Json::Kind::NUMBER;
+		_value.text = std::string(text.substr(start, at - start));
+		return true;
+	}
+
+	bool String(std::string& _result)
+	{
+		if (Peek() != '"') { return Fail(); }
+		at++;
+
+		while (at < text.size() && text[at] != '"')
+		{
+			char c = text[at++];
+			if ((unsigned char)c < 0x20) { return Fail(); }
+			if (c != '\\') { _result += c; continue; }
+
+			switch (Peek())
+			{
+				case '"': case '\\': case '/': _result += text[at++]; break;
+				case 'b': _result += '\b'; at++; break;
+				case 'f': _result += '\f'; at++; break;
+				case 'n': _result += '\n'; at++; break;
+				case 'r': _result += '\r'; at++; break;
+				case 't': _result += '\t'; at++; break;
+				case 'u':
+				{
+					if (at + 5 > text.size()) { return Fail(); }
+					unsigned code = 0;
+
+					for (size_t i = 1; i <= 4; i++)
+					{
+						char h = text[at + i];
+						if (!std::isxdigit((unsigned char)h)) { return Fail(); }
+						code = code * 16 + (unsigned)(std::isdigit((unsigned char)h) ? h - '0' : std::tolower((unsigned char)h) - 'a' + 10);
+					}
+
+					if (code >= 0x80) { return Fail(); } //Names are bytes, nothing past ASCII is escaped
+					_result += (char)code;
+					at += 5;
+				} break;
+				default: return Fail();
+			}
+		}
+
+		if (at >= text.size()) { return Fail(); }
+		at++;
+		return true;
+	}
+
+	void Space()
+	{
+		while (Peek() == ' ' || Peek() == '\t' || Peek() == '\n' || Peek() == '\r') { at++; }
+	}
+
+	bool Value(Json& _value)
+	{
+		Space();
+
+		switch (Peek())
+		{
+			case 'n': _value.kind = Json::Kind::NUL; return Literal("null");
+			case 't': _value.kind = Json::Kind::BOOLEAN; _value.text = "true"; return Literal("true");
+			case 'f': _value.kind = Json::Kind::BOOLEAN; _value.text = "false"; return Literal("false");
+			case '"': _value.kind = Json::Kind::STRING; return String(_value.text);
+			case '[':
+			{
+				_value.kind = Json::Kind::ARRAY;
+				at++;
+				Space();
+				if (Peek() == ']') { at++; return true; }
+
+				do
+				{
+					if (Peek() == ',') { at++; }
+					_value.items.emplace_back();
+					if (!Value(_value.items.back())) { return false; }
+					Space();
+				} while (Peek() == ',');
+
+				return Literal("]");
+			}
+			case '{':
+			{
+				_value.kind = Json::Kind::OBJECT;
+				at++;
+				Space();
+				if (Peek() == '}') { at++; return true; }
+
+				do
+				{
+					if (Peek() == ',') { at++; }
+					Space();
+					_value.members.emplace_back();
+					if (!String(_value.members.back().first)) { return false; }
+					Space();
+					if (!Literal(":") || !Value(_value.members.back().second)) { return false; }
+					Space();
+				} while (Peek() == ',');
+
+				return Literal("}");
+			}
+			default: return Number(_value);
+		}
+	}
+
+public:
+	//Returns false unless all of _text is one JSON value
+	bool Read(std::string_view _text, Json& _value)
+	{
+		text = _text;
+		at = 0;
+		if (!Value(_value) || Failed()) { return false; }
+		Space();
+		return at == text.size();
+	}
+};
+#pragma endregion
+
+//Reads back every node of _json and requires it to match the node of the tree in kind, name and value
+static bool MatchJson(const Json& _json, Statement* _node, std::string& _error)
+{
+	auto fail = [&](const std::string& _what) { _error = _what; return false; };
+	if (!_node) { return _json.kind == Json::Kind::NUL || fail("a missing statement is not null"); }
+
+	const Json* kind = _json.Find("kind");
+	if (_json.kind != Json::Kind::OBJECT || !kind || !_json.Find("line") || !_json.Find("column")) { return fail("a node without its kind or position"); }
+
+	if (_node->GetID() == StmtID::BLOCK)
+	{
+		const Json* statements = _json.Find("statements");
+		auto children = ((Block*)_node)->GetStatements();
+		if (kind->text != "Block" || !statements || statements->items.size() != children.size) { return fail("a block differs"); }
+
+		for (size_t i = 0; i < children.size; i++)
+		{
+			if (!MatchJson(statements->items[i], children[i], _error)) { return false; }
+		}
+
+		return true;
+	}
+
+	if (_node->GetID() == StmtID::VARDECL)
+	{
+		VarDecl* decl = (VarDecl*)_node;
+		const Json* name = _json.Find("name"), * type = _json.Find("type"), * expr = _json.Find("expr");
+
+		if (kind->text != "VarDecl" || !name || name->text != GetSymbolText(decl->GetVarName()) || !type || type->text != GetSymbolText(decl->GetTypeName()) || !expr)
+			return fail("a declaration of " + std::string(GetSymbolText(decl->GetVarName())) + " differs");
+
+		return MatchJson(*expr, decl->GetExpr(), _error);
+	}
+
+	switch (((Expression*)_node)->GetID())
+	{
+		case ExprID::BINOP:
+		{
+			Binop* binop = (Binop*)_node;
+			const Json* op = _json.Find("op"), * left = _json.Find("left"), * right = _json.Find("right");
+			if (kind->text != "Binop" || !op || op->text != GetBinopSymbol(binop->GetOP()) || !left || !right) { return fail("a binop differs"); }
+			return MatchJson(*left, binop->GetLeft(), _error) && MatchJson(*right, binop->GetRight(), _error);
+		}
+		case ExprID::IDENTIFIER:
+		{
+			const Json* name = _json.Find("name");
+			std::string_view expected = GetSymbolText(((Identifier*)_node)->GetName());
+			return (kind->text == "Identifier" && name && name->kind == Json::Kind::STRING && name->text == expected) || fail("the name " + std::string(expected) + " differs");
+		}
+		case ExprID::LITERAL:
+		{
+			const Value& value = ((Literal*)_node)->GetValue();
+			const Json* json = _json.Find("value");
+			if (kind->text != "Literal" || !json) { return fail("a literal differs"); }
+
+			if (value.IsUnit()) { return json->kind == Json::Kind::NUL || fail("a unit literal is not null"); }
+			if (!value.IsFloat()) { return json->text == (value.IsBool() ? (value.AsBool() ? "true" : "false") : value.ToString()) || fail("the literal " + value.ToString() + " differs"); }
+
+			//Non-finite floats become strings; finite ones must read back bit for bit
+			FLOAT f = value.AsFloat();
+			if (std::isnan(f)) { return (json->kind == Json::Kind::STRING && json->text == "nan") || fail("NaN is written as " + json->text); }
+			if (std::isinf(f)) { return (json->kind == Json::Kind::STRING && json->text == (f < 0 ? "-inf" : "inf")) || fail("an infinity is written as " + json->text); }
+			if (json->kind != Json::Kind::NUMBER) { return fail("the float " + value.ToString() + " is not a number"); }
+			return Value(std::strtod(json->text.c_str(), nullptr)).GetBits() == value.GetBits() || fail("the float " + json->text + " does not read back");
+		}
+		default: return fail("a node of unknown kind");
+	}
+}
+
+static void TestTree(Block* _block, const std::string& _label)
+{
+	StringBuilder builder;
+	_block->ToString(builder);
+	Expect(DumpText(_block, dump::Format::TREE) == builder.GetString() + "\n", _label + ": the TREE dump differs from ToString");
+
+	std::string text = DumpText(_block, dump::Format::JSON);
+	Json json;
+	std::string error;
+
+	if (!Expect(!text.empty() && text.back() == '\n' && JsonReader().Read(text, json), _label + ": the JSON dump is not valid JSON\n" + text)) { return; }
+	Expect(MatchJson(json, _block, error), _label + ": the JSON dump does not read back, " + error + "\n" + text);
+}
+
+static void TestSource(const std::string& _source, const std::string& _label)
+{
+	Arena arena;
+	Diagnostics diagnostics;
+	Block* block = parser::Parse(_source, 4, arena, diagnostics);
+	TestTree(block, _label);
+
+	//The flat tree dumps the same text as the pointer tree
+	Diagnostics flatDiagnostics;
+	FlatTree tree = parser::ParseFlat(_source, 4, flatDiagnostics);
+	StringBuilder builder;
+	tree.ToString(builder);
+	Expect(DumpText(tree, dump::Format::TREE) == builder.GetString() + "\n", _label + ": the TREE dump of the flat tree differs from its ToString");
+
+	for (dump::Format format : { dump::Format::TREE, dump::Format::COMPACT, dump::Format::JSON })
+	{
+		Expect(DumpText(tree, format) == DumpText(block, format),
+			_label + ": the " + std::string(dump::GetFormatName(format)) + " dump of the flat tree differs from the pointer tree");
+	}
+}
+
+//Values and names the parser never produces: non-finite floats, which folding can leave in a tree, and names with
+//quotes, backslashes and control characters
+static void TestBuiltTree()
+{
+	Arena arena;
+	Position position(1, 1);
+	std::vector<Statement*> statements;
+
+	for (FLOAT value : { std::numeric_limits<FLOAT>::quiet_NaN(), -std::numeric_limits<FLOAT>::quiet_NaN(), std::numeric_limits<FLOAT>::infinity(),
+		-std::numeric_limits<FLOAT>::infinity(), 0.0, -0.0, 0.1, 1e300, 5e-324, -2.5 })
+	{
+		statements.push_back(arena.New<Literal>(Value(value), position));
+	}
+
+	const std::string_view NAMES[] = { "plain", "quote\"d", "back\\slash", "tab\tnew\nline", std::string_view("nul\0byte", 8), "\x01\x1f\x7f", "\\u0041", "/" };
+
+	for (std::string_view name : NAMES)
+	{
+		Symbol symbol = Intern(name);
+		Expression* identifier = arena.New<Identifier>(symbol, position);
+		statements.push_back(arena.New<VarDecl>(symbol, Intern("ty\"pe"), identifier, position));
+		statements.push_back(arena.New<Binop>(arena.New<Identifier>(symbol, position), BinopOP::ADD, arena.New<Literal>(Value((BOOL)true), position), position));
+	}
+
+	statements.push_back(nullptr);
+	statements.push_back(arena.New<Literal>(Value((INT)LLONG_MIN), position));
+	statements.push_back(arena.New<Literal>(Value(), position));
+
+	Block* block = arena.New<Block>(arena.NewArray(statements.data(), statements.size()), position);
+	TestTree(block, "a built tree");
+}
+
+int main()
+{
+	for (size_t i = 0; i < std::size(SOURCES); i++)
+		TestSource(SOURCES[i], "source " + std::to_string(i));
+
+	Random random(25);
+	for (size_t i = 0; i < 100; i++)
+		TestSource(GenerateProgram(random), "program " + std::to_string(i));
+
+	TestBuiltTree();
+
+	return Finish("DumpTest");
+}
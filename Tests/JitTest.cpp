@@ -0,0 +1,156 @@
+#include "pch.h"
+#include "Test.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Checker.h"
+#include "Optimizer.h"
+#include "Bytecode.h"
+#include "Jit.h"
+
+using namespace ede;
+using namespace ede::test;
+
+//Runs every program on the interpreter, the VM and the JIT and requires the same result and diagnostics, bit for bit
+static const char* const SOURCES[] = {
+	"9223372036854775807 + 1;",
+	"(0 - 9223372036854775807 - 1) - 1;",
+	"4611686018427387904 * 2;",
+	"(0 - 9223372036854775807 - 1) * (0 - 1);",
+	"(0 - 9223372036854775807 - 1) / (0 - 1);",
+	"(0 - 9223372036854775807 - 1) % (0 - 1);",
+	"7 % (0 - 1);",
+	"(0 - 7) % (0 - 1);",
+	"(0 - 7) / 2;",
+	"(0 - 7) % 2;",
+	"7 % (0 - 2);",
+	"1 / 0;",
+	"1 % 0;",
+	"0 / 0;",
+	"let a : int = 0; let b : int = 5 / a; b;",
+	"let a : int = 0 - 1; 9223372036854775807 % a;",
+	"5.5 % 2.0;",
+	"(0.0 - 5.5) % 2.0;",
+	"5.5 % (0.0 - 2.0);",
+	"5.5 % 0.0;",
+	"0.0 % 0.0;",
+	"1.0 / 0.0;",
+	"(0.0 - 1.0) / 0.0;",
+	"0.0 / 0.0;",
+	"0.0 * (0.0 - 1.0);",
+	"123456789012345678901234567890.5 * 123456789012345678901234567890.5 * 123456789012345678901234567890.5;",
+	"let x : float = 0.1; x + 0.2;",
+	"{ let x : int = 1; { let y : int = x + 1; { let z : int = y * 3; z % 4; } } }",
+	"let a : int = 2; { let b : int = a * a; { b; } } a;",
+	"{ { { } } }",
+	"let a : int = 1; { let b : int = 9223372036854775807; { b + a; } } 3;",
+	"",
+	"true;",
+	"let b : bool = false; b;",
+};
+
+//What one evaluator made of a program
+struct Outcome
+{
+	bool success;
+	interpreter::Result value;
+	std::string diagnostics;
+};
+
+static bool Same(const Outcome& _a, const Outcome& _b)
+{
+	return _a.success == _b.success && _a.value.GetType() == _b.value.GetType() && _a.value.GetBits() == _b.value.GetBits() && _a.diagnostics == _b.diagnostics;
+}
+
+static std::string Describe(const Outcome& _outcome)
+{
+	return _outcome.success ? _outcome.value.ToString() : _outcome.diagnostics;
+}
+
+static void TestProgram(const std::string& _source, const std::string& _label, bool _fold, bool _mustCompile)
+{
+	Arena arena;
+	Diagnostics diagnostics;
+	Block* block = parser::Parse(_source, 4, arena, diagnostics);
+	uint32_t frameSize = 0;
+
+	if (_fold) { optimizer::FoldConstants(block, arena, diagnostics); }
+	resolver::Resolve(block, frameSize, diagnostics);
+	checker::Check(block, diagnostics);
+
+	//Folding reports the runtime errors it finds ahead of time, which leaves nothing to run
+	if (_fold && diagnostics.GetCount() != 0) { return; }
+	if (!Expect(diagnostics.GetCount() == 0, _label + ": does not compile\n" + _source + PrintDiagnostics(diagnostics))) { return; }
+
+	Outcome interpreted, vm, jit;
+	Diagnostics interpreterDiagnostics, vmDiagnostics, jitDiagnostics;
+
+	interpreted.value = interpreter::Evaluate(block, frameSize, interpreterDiagnostics);
+	interpreted.success = interpreterDiagnostics.GetCount() == 0;
+	interpreted.diagnostics = PrintDiagnostics(interpreterDiagnostics);
+
+	vm::VM machine;
+	vm.success = machine.Run(vm::Compile(block, frameSize), vm.value, vmDiagnostics);
+	vm.diagnostics = PrintDiagnostics(vmDiagnostics);
+
+	Expect(Same(interpreted, vm), _label + ": the interpreter gave " + Describe(interpreted) + " and the VM " + Describe(vm) + "\n" + _source);
+
+	std::unique_ptr<jit::Program> program = jit::Compile(block, frameSize);
+	if (!program)
+	{
+		Expect(!_mustCompile || !jit::IsSupported(), _label + ": not compiled to native code");
+		return;
+	}
+
+	jit.success = program->Run(jit.value, jitDiagnostics);
+	jit.diagnostics = PrintDiagnostics(jitDiagnostics);
+	Expect(Same(jit, vm), _label + ": the JIT gave " + Describe(jit) + " and the VM " + Describe(vm) + "\n" + _source);
+
+	//The frame is reused, a second run must not see the first
+	Outcome again;
+	Diagnostics againDiagnostics;
+	again.success = program->Run(again.value, againDiagnostics);
+	again.diagnostics = PrintDiagnostics(againDiagnostics);
+	Expect(Same(again, jit), _label + ": a second JIT run gave " + Describe(again) + "\n" + _source);
+}
+
+//1 + (1 + (1 + ...)) keeps one temporary per level on the native stack
+static std::string RightNested(size_t _depth, const char* _operand)
+{
+	std::string source;
+
+	for (size_t i = 0; i < _depth; i++)
+		source += std::string("(") + _operand + " + ";
+
+	return source + _operand + std::string(_depth, ')') + ";";
+}
+
+int main()
+{
+	for (size_t i = 0; i < std::size(SOURCES); i++)
+	{
+		TestProgram(SOURCES[i], "source " + std::to_string(i), false, true);
+		TestProgram(SOURCES[i], "folded source " + std::to_string(i), true, true);
+	}
+
+	Random random(19);
+
+	for (size_t i = 0; i < 3000; i++)
+	{
+		std::string source = GenerateProgram(random);
+		TestProgram(source, "program " + std::to_string(i), false, true);
+		TestProgram(source, "folded program " + std::to_string(i), true, true);
+	}
+
+	//Below the JIT's limit of 4096 temporaries the code is native, past it the program is left to the VM
+	TestProgram("let a : int = 1;\n" + RightNested(4000, "a"), "right operands 4000 deep", false, true);
+	TestProgram("let a : float = 0.5;\n" + RightNested(4000, "a"), "float right operands 4000 deep", false, true);
+	TestProgram("let a : int = 1;\n" + RightNested(5000, "a"), "right operands 5000 deep", false, false);
+	TestProgram("let a : int = 1;\n" + RightNested(100000, "a"), "right operands 100000 deep", false, false);
+
+	//A left chain keeps no temporaries, however long
+	std::string chain = "let a : int = 3;\na";
+	for (size_t i = 0; i < 100000; i++) { chain += i % 3 ? " * a" : " - 7"; }
+	TestProgram(chain + ";", "a long left chain", false, true);
+
+	return Finish("JitTest");
+}
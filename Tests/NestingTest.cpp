@@ -0,0 +1,144 @@
+#include "pch.h"
+#include "Test.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Checker.h"
+#include "Optimizer.h"
+#include "Bytecode.h"
+#include "Dump.h"
+
+using namespace ede;
+using namespace ede::test;
+
+//Feeds parentheses, operators and blocks nested up to and past parser::Limits. Past a limit the parser must report
+//ERROR_NestingTooDeep once and go on with the next statement; below it every pass must handle the depth without
+//recursing. Either way a failure shows as a crash of the test.
+static std::string Parens(size_t _depth)
+{
+	return std::string(_depth, '(') + "1" + std::string(_depth, ')');
+}
+
+//1 + (1 + (1 + ...)), which nests _depth operators and _depth - 1 parentheses; both count towards the limit
+static std::string RightNested(size_t _depth)
+{
+	std::string source;
+
+	for (size_t i = 0; i + 1 < _depth; i++)
+		source += "(1 + ";
+
+	return source + (_depth != 0 ? "1 + 1" : "1") + std::string(_depth != 0 ? _depth - 1 : 0, ')');
+}
+
+//1 + 1 - 1 + ..., whose leftmost operand is as deep as the chain is long, plus one for the atom
+static std::string LeftChain(size_t _operators)
+{
+	std::string source = "1";
+
+	for (size_t i = 0; i < _operators; i++)
+		source += i % 2 ? " - 1" : " + 1";
+
+	return source;
+}
+
+static std::string Blocks(size_t _depth)
+{
+	return std::string(_depth, '{') + "1;" + std::string(_depth, '}');
+}
+
+//Parses _statement followed by a statement of its own, and requires exactly _errors nesting errors and no other
+//diagnostic, and the statement after it in the tree either way
+static void TestLimit(const std::string& _statement, const parser::Limits& _limits, size_t _errors, const std::string& _label)
+{
+	std::string source = _statement + "\nlet after : int = 2;\nafter;\n";
+	Arena arena;
+	Diagnostics diagnostics;
+	Block* block = parser::Parse(source, 4, arena, diagnostics, _limits);
+
+	size_t nesting = 0;
+	for (const Diagnostic& diagnostic : diagnostics.GetDiagnostics())
+	{
+		if (diagnostic.type == DiagnosticType::ERROR_NestingTooDeep) { nesting++; }
+	}
+
+	Expect(nesting == _errors, _label + ": " + std::to_string(nesting) + " nesting errors instead of " + std::to_string(_errors));
+	Expect(diagnostics.GetCount() == nesting, _label + ": other diagnostics\n" + PrintDiagnostics(diagnostics));
+
+	auto statements = block->GetStatements();
+	Expect(statements.size != 0 && statements[statements.size - 1] && statements[statements.size - 1]->GetID() == StmtID::EXPR,
+		_label + ": the statement after it is missing");
+
+	//The flat tree is built by the same parser with another builder
+	Diagnostics flatDiagnostics;
+	parser::ParseFlat(source, 4, flatDiagnostics, _limits);
+	Expect(PrintDiagnostics(flatDiagnostics) == PrintDiagnostics(diagnostics), _label + ": ParseFlat reports otherwise");
+
+	//Whatever was parsed, the later passes take it
+	uint32_t frameSize = 0;
+	resolver::Resolve(block, frameSize, diagnostics);
+	checker::Check(block, diagnostics);
+	DescribeTree(block);
+}
+
+//Expressions as deep as the default limits allow go through every pass and come out with the right value
+static void TestDeepExpression(const std::string& _expression, INT _expected, const std::string& _label)
+{
+	Arena arena;
+	Diagnostics diagnostics;
+	Block* block = parser::Parse(_expression + ";", 4, arena, diagnostics);
+	if (!Expect(diagnostics.GetCount() == 0, _label + ": does not parse\n" + PrintDiagnostics(diagnostics))) { return; }
+
+	uint32_t frameSize = 0;
+	resolver::Resolve(block, frameSize, diagnostics);
+	checker::Check(block, diagnostics);
+
+	std::ostringstream dump;
+	{
+		dump::Writer writer(dump);
+		dump::Dump(block, dump::Format::COMPACT, writer);
+	}
+
+	interpreter::Result interpreted = interpreter::Evaluate(block, frameSize, diagnostics);
+	vm::VM vm;
+	interpreter::Result result;
+	vm.Run(vm::Compile(block, frameSize), result, diagnostics);
+
+	Expect(diagnostics.GetCount() == 0 && interpreted.IsInt() && interpreted.AsInt() == _expected && result.IsInt() && result.AsInt() == _expected,
+		_label + ": gave " + interpreted.ToString() + " and " + result.ToString() + PrintDiagnostics(diagnostics));
+
+	optimizer::FoldConstants(block, arena, diagnostics);
+	auto statements = block->GetStatements();
+	Expect(statements.size == 1 && statements[0]->GetID() == StmtID::EXPR && ((Expression*)statements[0])->GetID() == ExprID::LITERAL,
+		_label + ": not folded to a literal");
+}
+
+int main()
+{
+	parser::Limits limits;
+	limits.maxExpressionDepth = 50;
+	limits.maxBlockDepth = 10;
+
+	TestLimit(Parens(50) + ";", limits, 0, "parentheses at the limit");
+	TestLimit(Parens(51) + ";", limits, 1, "parentheses past the limit");
+	TestLimit(RightNested(25) + ";", limits, 0, "right operands at the limit");
+	TestLimit(RightNested(26) + ";", limits, 1, "right operands past the limit");
+	TestLimit(LeftChain(49) + ";", limits, 0, "a left chain at the limit");
+	TestLimit(LeftChain(50) + ";", limits, 1, "a left chain past the limit");
+	TestLimit("let v : int = " + Parens(1000) + ";", limits, 1, "an initializer far past the limit");
+	TestLimit(Blocks(10), limits, 0, "blocks at the limit");
+	TestLimit(Blocks(11), limits, 1, "blocks past the limit");
+	TestLimit(Blocks(10) + Blocks(11) + Blocks(12), limits, 2, "blocks past the limit twice");
+	TestLimit(Blocks(5) + "\n" + std::string(5, '{') + Parens(51) + ";" + std::string(5, '}'), limits, 1, "parentheses past the limit in a block");
+
+	//Far past the default limits, deep enough to overflow the stack of a recursive parser many times over
+	parser::Limits defaults;
+	TestLimit(Parens(3000000) + ";", defaults, 1, "3 million parentheses");
+	TestLimit(RightNested(600000) + ";", defaults, 1, "600000 right operands");
+	TestLimit(LeftChain(1100000) + ";", defaults, 1, "1.1 million operators in a chain");
+	TestLimit(Blocks(1000000), defaults, 1, "a million blocks");
+
+	TestDeepExpression(Parens(1000000), 1, "a million parentheses");
+	TestDeepExpression(RightNested(500000), 500001, "half a million right operands");
+	TestDeepExpression(LeftChain(1000000), 1, "a million operators in a chain");
+
+	return Finish("NestingTest");
+}
@@ -0,0 +1,89 @@
+#include "pch.h"
+#include "Test.h"
+#include "Parser.h"
+
+using namespace ede;
+using namespace ede::test;
+
+//Parses files large enough to be sliced with ParseParallel and with Parse, and requires the same tree, positions and
+//diagnostics. Errors are injected at random, so that pieces are reparsed from the first dirty one on.
+static const size_t MIN_SLICE_SIZE = 64 * 1024; //As in ParseParallel, which does not slice files under twice this
+
+//Top-level statements of generated programs until the file holds at least _size bytes. Some programs are indented
+//with tabs or written on one line, since slices start at the column after a semicolon.
+static std::string GenerateFile(Random& _random, size_t _size)
+{
+	std::string source;
+
+	while (source.size() < _size)
+	{
+		std::string program = GenerateProgram(_random);
+		if (_random.Chance(30)) { std::replace(program.begin(), program.end(), '\n', ' '); }
+		source += (_random.Chance(30) ? "\t" : "") + program;
+	}
+
+	return source;
+}
+
+//Text that breaks the statement it lands in, or the slicing around it: brackets that never close, or close more than
+//opened and drive the depth SliceSource counts negative, or cut a statement in two
+static const char* const ERRORS[] = { ")", ")", "))", "(", "{", "}", ";", "@", "let ", " + ", "1.5.", "= ", ":" };
+
+static std::string InjectErrors(Random& _random, std::string _source, size_t _count)
+{
+	for (size_t i = 0; i < _count; i++)
+	{
+		size_t offset = (size_t)_random.Range(0, _source.size());
+
+		if (_random.Chance(20)) { _source.erase(offset, (size_t)_random.Range(1, 20)); }
+		else { _source.insert(offset, ERRORS[_random.Range(0, std::size(ERRORS) - 1)]); }
+	}
+
+	return _source;
+}
+
+static void TestFile(const std::string& _source, const std::string& _label)
+{
+	Arena arena;
+	Diagnostics diagnostics;
+	std::string expected = DescribeTree(parser::Parse(_source, 4, arena, diagnostics));
+	std::string expectedDiagnostics = PrintDiagnostics(diagnostics);
+
+	for (size_t jobs : { 2, 4, 7 })
+	{
+		Arena parallelArena;
+		Diagnostics parallelDiagnostics;
+		Block* block = parser::ParseParallel(_source, 4, parallelArena, parallelDiagnostics, jobs);
+		std::string label = _label + " on " + std::to_string(jobs) + " jobs";
+
+		Expect(DescribeTree(block) == expected, label + ": the tree differs from Parse");
+		Expect(PrintDiagnostics(parallelDiagnostics) == expectedDiagnostics, label + ": the diagnostics differ from Parse");
+	}
+}
+
+int main()
+{
+	Random random(16);
+	std::string valid = GenerateFile(random, 6 * MIN_SLICE_SIZE);
+	size_t middle = valid.find(";\n", valid.size() / 2) + 2;
+
+	TestFile(valid, "a valid file");
+	TestFile("@" + valid, "an error in the first piece");
+	TestFile(valid + "1 +;\n", "an error in the last piece");
+	TestFile(valid.substr(0, middle) + "let x : int = ;\n" + valid.substr(middle), "an error in the middle");
+
+	//Slicing stops for good after a stray ')', and a '(' later brings the depth back to 0 inside an expression
+	TestFile(")\n" + valid, "a stray ) at the start");
+	TestFile(")\n" + valid.substr(0, middle) + "(1 + 2;\n" + valid.substr(middle), "a stray ) and an unclosed (");
+	TestFile(valid.substr(0, middle) + ");\n" + valid.substr(middle), "a stray ) in the middle");
+	TestFile("{\n" + valid, "a block that never closes");
+
+	for (size_t i = 0; i < 24; i++)
+	{
+		std::string source = GenerateFile(random, (size_t)random.Range(2 * MIN_SLICE_SIZE, 10 * MIN_SLICE_SIZE));
+		size_t errors = i % 4 == 0 ? 0 : (size_t)random.Range(1, 5);
+		TestFile(InjectErrors(random, source, errors), "file " + std::to_string(i) + " with " + std::to_string(errors) + " errors");
+	}
+
+	return Finish("ParallelParseTest");
+}
@@ -0,0 +1,247 @@
+#include "pch.h"
+#include "Test.h"
+#include "Serializer.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Checker.h"
+#include "Bytecode.h"
+
+using namespace ede;
+using namespace ede::test;
+
+//Round-trips parsed trees through the cache format, then checks that files for other sources, truncated, bit-flipped
+//and hand-made files are rejected, or decode to trees the later passes handle like any other
+static const serializer::SourceKey KEY = { 1234, 0x0123456789ABCDEFull, 0xFEDCBA9876543210ull };
+
+static const char* const SOURCES[] = {
+	"",
+	"1;",
+	"let a : int = 1;\na;\n",
+	"let x : float = 1.5 * (2.25 - 0.5);\nx % 0.75;\n",
+	"{ let x : int = 1; { let y : int = x + 2; y; } }\n{ }\n",
+	"true;\nfalse;\n",
+	"let a : int = ;\n1 +;\nlet : int = 1;\n{ 2;\n", //Parse errors leave statements out of the tree
+	"let b : bool = 1;\nundeclared * 2;\n", //Resolver and checker errors are not the decoder's business
+};
+
+#pragma region Helpers
+static void WriteVarint(std::string& _out, uint64_t _value)
+{
+	for (; _value >= 0x80; _value >>= 7) { _out.push_back((char)(_value | 0x80)); }
+	_out.push_back((char)_value);
+}
+
+//A file with the header and name table EncodeTree would write, followed by _tree as given
+static std::string MakeFile(const std::vector<std::string>& _names, const std::vector<uint8_t>& _tree)
+{
+	uint32_t version = serializer::FORMAT_VERSION, count = (uint32_t)_names.size(), reserved = 0;
+	std::string file("EDET");
+
+	file.append((const char*)&version, sizeof(version));
+	file.append((const char*)&KEY, sizeof(KEY));
+	file.append((const char*)&count, sizeof(count));
+	file.append((const char*)&reserved, sizeof(reserved));
+
+	for (const std::string& name : _names)
+	{
+		WriteVarint(file, name.size());
+		file += name;
+	}
+
+	file.append(_tree.begin(), _tree.end());
+	return file;
+}
+
+static Block* Decode(const std::string& _data, Arena& _arena, const parser::Limits& _limits = parser::Limits())
+{
+	return serializer::DecodeTree(_data, KEY, _arena, _limits);
+}
+
+//Runs what the driver runs after loading a tree from the cache; the test fails by crashing if a pass cannot cope
+static void Exercise(Block* _block)
+{
+	Diagnostics diagnostics;
+	uint32_t frameSize = 0;
+
+	resolver::Resolve(_block, frameSize, diagnostics);
+	checker::Check(_block, diagnostics);
+	DescribeTree(_block);
+
+	if (diagnostics.GetCount() != 0) { return; }
+
+	vm::VM vm;
+	interpreter::Result result;
+	vm.Run(vm::Compile(_block, frameSize), result, diagnostics);
+}
+#pragma endregion
+
+static void TestRoundTrip(const std::string& _source, const std::string& _label)
+{
+	Arena arena;
+	Diagnostics diagnostics;
+	Block* block = parser::Parse(_source, 4, arena, diagnostics);
+	std::string data = serializer::EncodeTree(block, KEY);
+
+	Arena decodedArena;
+	Block* decoded = Decode(data, decodedArena);
+	if (!Expect(decoded != nullptr, _label + ": the encoded tree does not decode")) { return; }
+
+	Expect(DescribeTree(decoded) == DescribeTree(block), _label + ": the decoded tree differs");
+	Expect(serializer::EncodeTree(decoded, KEY) == data, _label + ": re-encoding the decoded tree gives other bytes");
+}
+
+//A tree is only loaded for a source with the same size and both hashes
+static void TestSourceKeys()
+{
+	std::string data = MakeFile({}, { 1, 1, 0 });
+	serializer::SourceKey keys[] = { KEY, KEY, KEY };
+	keys[0].size++;
+	keys[1].hash++;
+	keys[2].check++;
+
+	for (const serializer::SourceKey& key : keys)
+	{
+		Arena arena;
+		Expect(serializer::DecodeTree(data, key, arena) == nullptr, "decoded for another source");
+	}
+
+	serializer::SourceKey empty = serializer::HashSource(std::string_view());
+	Expect(empty.size == 0, "the empty source has a size");
+
+	//Sources that differ in size or in any one byte get keys that differ in both hashes
+	std::string source = "let a : int = 1;\na + 2;\n";
+	serializer::SourceKey original = serializer::HashSource(source);
+	Expect(original.size == source.size(), "the key has the wrong size");
+
+	std::vector<std::string> others = { source + " ", source.substr(0, source.size() - 1), source + '\0', std::string() };
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		others.push_back(source);
+		others.back()[i] ^= 1;
+	}
+
+	for (const std::string& other : others)
+	{
+		serializer::SourceKey key = serializer::HashSource(other);
+		Expect(key.hash != original.hash && key.check != original.check, "the key of " + other + " matches the key of " + source);
+	}
+}
+
+static void TestCorruption(const std::string& _source, const std::string& _label)
+{
+	Arena arena;
+	Diagnostics diagnostics;
+	std::string data = serializer::EncodeTree(parser::Parse(_source, 4, arena, diagnostics), KEY);
+
+	for (size_t size = 0; size < data.size(); size++)
+	{
+		Arena decodedArena;
+		Expect(Decode(data.substr(0, size), decodedArena) == nullptr, _label + ": decoded when truncated to " + std::to_string(size) + " bytes");
+	}
+
+	//Every bit of every byte, then every tag in the low nibble of every byte
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		for (int change = 0; change < 24; change++)
+		{
+			std::string corrupt = data;
+			corrupt[i] = change < 8 ? (char)(corrupt[i] ^ (1 << change)) : (char)((corrupt[i] & 0xF0) | (change - 8));
+
+			Arena decodedArena;
+			if (Block* block = Decode(corrupt, decodedArena)) { Exercise(block); }
+		}
+	}
+}
+
+static void TestInvalidTrees()
+{
+	enum : uint8_t { NONE = 0, BLOCK = 1, VARDECL = 2, IDENTIFIER = 3, LIT_INT = 5, BINOP_ADD = 9 };
+
+	//Nodes are a tag with a line delta of 0 and a column of 1; names are 1-based, 0 being INVALID_SYMBOL
+	struct Case { const char* label; std::vector<uint8_t> tree; bool valid; };
+
+	const Case cases[] = {
+		{ "let a : int = 1; a", { BLOCK, 1, 2, VARDECL, 1, 1, 2, LIT_INT, 1, 2, IDENTIFIER, 1, 1 }, true },
+		{ "a statement that failed to parse", { BLOCK, 1, 2, NONE, LIT_INT, 1, 2 }, true },
+		{ "a declaration without a name", { BLOCK, 1, 1, VARDECL, 1, 0, 2, LIT_INT, 1, 2 }, false },
+		{ "a declaration without a type", { BLOCK, 1, 1, VARDECL, 1, 1, 0, LIT_INT, 1, 2 }, false },
+		{ "an identifier without a name", { BLOCK, 1, 1, IDENTIFIER, 1, 0 }, false },
+		{ "a name past the table", { BLOCK, 1, 1, IDENTIFIER, 1, 3 }, false },
+		{ "a declaration without an initializer", { BLOCK, 1, 1, VARDECL, 1, 1, 2, NONE }, false },
+		{ "a block as an initializer", { BLOCK, 1, 1, VARDECL, 1, 1, 2, BLOCK, 1, 0 }, false },
+		{ "a declaration as an initializer", { BLOCK, 1, 1, VARDECL, 1, 1, 2, VARDECL, 1, 1, 2, LIT_INT, 1, 2 }, false },
+		{ "a Binop without a left operand", { BLOCK, 1, 1, BINOP_ADD, 1, NONE, LIT_INT, 1, 2 }, false },
+		{ "a Binop without a right operand", { BLOCK, 1, 1, BINOP_ADD, 1, LIT_INT, 1, 2, NONE }, false },
+		{ "a block as an operand", { BLOCK, 1, 1, BINOP_ADD, 1, LIT_INT, 1, 2, BLOCK, 1, 0 }, false },
+		{ "an unknown tag", { BLOCK, 1, 1, 15, 1 }, false },
+		{ "a declaration as the root", { VARDECL, 1, 1, 2, LIT_INT, 1, 2 }, false },
+	};
+
+	for (const Case& test : cases)
+	{
+		Arena arena;
+		Expect((Decode(MakeFile({ "a", "int" }, test.tree), arena) != nullptr) == test.valid,
+			std::string(test.label) + (test.valid ? ": rejected" : ": accepted"));
+	}
+}
+
+//The decoder accepts blocks exactly as deep as the parser does
+static void TestBlockDepth()
+{
+	parser::Limits limits;
+	limits.maxBlockDepth = 3;
+
+	for (size_t nested = 0; nested <= 5; nested++)
+	{
+		std::string source = std::string(nested, '{') + std::string(nested, '}');
+		Arena arena;
+		Diagnostics diagnostics;
+		parser::Parse(source, 4, arena, diagnostics, limits);
+
+		std::vector<uint8_t> tree;
+		for (size_t i = 0; i < nested; i++) { tree.insert(tree.end(), { 1, 1, 1 }); }
+		tree.insert(tree.end(), { 1, 1, 0 });
+
+		Expect((Decode(MakeFile({}, tree), arena, limits) != nullptr) == (diagnostics.GetCount() == 0),
+			"the decoder and the parser disagree on " + std::to_string(nested) + " nested blocks");
+	}
+
+	//Deep enough to overflow the stack if blocks were decoded without a limit
+	std::vector<uint8_t> tree;
+	for (size_t i = 0; i < 1000000; i++) { tree.insert(tree.end(), { 1, 1, 1 }); }
+	tree.insert(tree.end(), { 1, 1, 0 });
+
+	Arena arena;
+	Expect(Decode(MakeFile({}, tree), arena) == nullptr, "a million nested blocks decoded");
+}
+
+int main()
+{
+	Random random(18);
+	std::vector<std::pair<std::string, std::string>> programs;
+
+	for (const char* source : SOURCES)
+		programs.emplace_back(source, "source " + std::to_string(programs.size()));
+
+	for (size_t i = 0; i < 300; i++)
+		programs.emplace_back(GenerateProgram(random), "program " + std::to_string(i));
+
+	std::string chain = "1";
+	for (size_t i = 0; i < 100000; i++) { chain += i % 2 ? " + 2" : " * 3"; }
+	programs.emplace_back(chain + ";", "a long chain");
+
+	std::string parens = std::string(100000, '(') + "1" + std::string(100000, ')');
+	programs.emplace_back(parens + ";", "deep parentheses");
+
+	for (auto& [source, label] : programs)
+		TestRoundTrip(source, label);
+
+	//The fixed sources and a few generated programs, every change to them decodes and runs
+	for (size_t i = 0; i < std::size(SOURCES) + 4; i++)
+		TestCorruption(programs[i].first, programs[i].second);
+
+	TestSourceKeys();
+	TestInvalidTrees();
+	TestBlockDepth();
+	return Finish("SerializerTest");
+}
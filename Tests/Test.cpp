@@ -0,0 +1,228 @@
+#include "pch.h"
+#include "Test.h"
+
+namespace ede::test
+{
+	static size_t failures = 0;
+
+	bool Expect(bool _condition, const std::string& _what)
+	{
+		if (!_condition)
+		{
+			failures++;
+			std::cerr << "FAILED: " << _what << std::endl;
+		}
+
+		return _condition;
+	}
+
+	int Finish(std::string_view _name)
+	{
+		std::cout << _name << ": " << (failures == 0 ? "passed" : std::to_string(failures) + " checks failed") << std::endl;
+		return failures == 0 ? 0 : 1;
+	}
+
+#pragma region Programs
+	class ProgramGenerator
+	{
+		Random& random;
+		std::string output;
+		std::vector<ProgramInput> scope;
+		size_t counter;
+
+		void WriteAtom(bool _float)
+		{
+			if (!scope.empty() && random.Chance(40))
+			{
+				const ProgramInput& binding = scope[random.Range(0, scope.size() - 1)];
+
+				if (binding.isFloat == _float)
+				{
+					output += binding.name;
+					return;
+				}
+			}
+
+			if (_float)
+			{
+				switch (random.Range(0, 5))
+				{
+					case 0: output += "0.0"; break;
+					case 1: output += "1.5"; break;
+					case 2: output += "123456789012345678901234567890.5"; break;
+					default:
+					{
+						uint64_t whole = random.Range(0, 99); //Drawn in a fixed order, unlike the operands of +
+						output += std::to_string(whole) + "." + std::to_string(random.Range(0, 99));
+					} break;
+				}
+
+				return;
+			}
+
+			switch (random.Range(0, 9))
+			{
+				case 0: output += "0"; break;
+				case 1: output += "(0 - 1)"; break;
+				case 2: output += "9223372036854775807"; break;
+				case 3: output += "(0 - 9223372036854775807 - 1)"; break;
+				case 4:
+				{
+					uint64_t shift = random.Range(1, 32);
+					output += std::to_string(random.Next() >> shift);
+				} break;
+				case 5: output += std::to_string(random.Range(0, 255)); break;
+				default: output += std::to_string(random.Range(0, 9)); break;
+			}
+		}
+
+		//Recurses, but only as deep as _depth
+		void WriteExpression(bool _float, size_t _depth)
+		{
+			if (_depth == 0 || random.Chance(25))
+			{
+				WriteAtom(_float);
+				return;
+			}
+
+			static const char* const OPERATORS[] = { " + ", " - ", " * ", " / ", " % " };
+			size_t op = random.Range(0, 4);
+			bool parenthesize = random.Chance(40);
+
+			if (parenthesize) { output += "("; }
+			WriteExpression(_float, _depth - 1);
+			output += OPERATORS[op];
+
+			//Bias divisors towards the interesting ones
+			if (op >= 3 && random.Chance(30)) { output += _float ? "0.0" : (random.Chance(50) ? "0" : "(0 - 1)"); }
+			else { WriteExpression(_float, _depth - 1); }
+
+			if (parenthesize) { output += ")"; }
+		}
+
+		void WriteBlock(size_t _depth, const std::string& _indent)
+		{
+			size_t outer = scope.size();
+
+			for (size_t i = random.Range(1, 6); i > 0; i--)
+			{
+				uint64_t kind = random.Range(0, 99);
+				bool isFloat = random.Chance(40);
+
+				if (kind < 15 && _depth < 5)
+				{
+					output += _indent + "{\n";
+					WriteBlock(_depth + 1, _indent + "\t");
+					output += _indent + "}\n";
+				}
+				else if (kind < 80)
+				{
+					std::string name = "v" + std::to_string(++counter);
+					output += _indent + "let " + name + (isFloat ? " : float = " : " : int = ");
+					WriteExpression(isFloat, random.Range(0, 7));
+					output += ";\n";
+					scope.push_back(ProgramInput{ name, isFloat });
+				}
+				else
+				{
+					output += _indent;
+					WriteExpression(isFloat, random.Range(0, 7));
+					output += ";\n";
+				}
+			}
+
+			scope.resize(outer);
+		}
+	public:
+		ProgramGenerator(Random& _random, const std::vector<ProgramInput>& _inputs) : random(_random), scope(_inputs), counter(0) { }
+
+		std::string Generate()
+		{
+			WriteBlock(0, "");
+
+			if (random.Chance(70))
+			{
+				WriteExpression(random.Chance(40), 5);
+				output += ";\n";
+			}
+
+			return std::move(output);
+		}
+	};
+
+	std::string GenerateProgram(Random& _random, const std::vector<ProgramInput>& _inputs)
+	{
+		ProgramGenerator generator(_random, _inputs);
+		return generator.Generate();
+	}
+#pragma endregion
+
+	std::string DescribeTree(Block* _block)
+	{
+		std::ostringstream text;
+		std::vector<Statement*> stack{ _block };
+
+		while (!stack.empty())
+		{
+			Statement* stmt = stack.back();
+			stack.pop_back();
+
+			if (!stmt)
+			{
+				text << "_\n";
+				continue;
+			}
+
+			Position position = stmt->GetPosition();
+			text << position.line << ":" << position.column << " ";
+
+			switch (stmt->GetID())
+			{
+				case StmtID::BLOCK:
+				{
+					auto statements = ((Block*)stmt)->GetStatements();
+					text << "Block " << statements.size << "\n";
+
+					for (size_t i = statements.size; i > 0; i--)
+						stack.push_back(statements[i - 1]);
+				} break;
+				case StmtID::VARDECL:
+				{
+					VarDecl* decl = (VarDecl*)stmt;
+					text << "VarDecl " << GetSymbolText(decl->GetVarName()) << " " << GetSymbolText(decl->GetTypeName()) << "\n";
+					stack.push_back(decl->GetExpr());
+				} break;
+				case StmtID::EXPR:
+				{
+					Expression* expr = (Expression*)stmt;
+
+					switch (expr->GetID())
+					{
+						case ExprID::BINOP:
+						{
+							Binop* binop = (Binop*)expr;
+							text << "Binop " << BinopOPToString(binop->GetOP()) << "\n";
+							stack.push_back(binop->GetRight());
+							stack.push_back(binop->GetLeft());
+						} break;
+						case ExprID::LITERAL:
+						{
+							const Value& value = ((Literal*)expr)->GetValue();
+							text << "Literal " << (int)value.GetType() << " " << value.GetBits() << "\n";
+						} break;
+						case ExprID::IDENTIFIER: text << "Identifier " << GetSymbolText(((Identifier*)expr)->GetName()) << "\n"; break;
+					}
+				} break;
+			}
+		}
+
+		return text.str();
+	}
+
+	std::string PrintDiagnostics(const Diagnostics& _diagnostics)
+	{
+		std::ostringstream stream;
+		_diagnostics.Print(stream);
+		return stream.str();
+	}
+};
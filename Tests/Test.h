@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Utilities.h"
+#include "ast.h"
+
+using namespace ede::ast;
+using namespace ede::utilities;
+
+//Helpers shared by the test programs. Each test is a plain executable that returns non-zero if a check failed.
+namespace ede::test
+{
+	//SplitMix64, so every standard library generates the same programs for a seed
+	class Random
+	{
+		uint64_t state;
+	public:
+		Random(uint64_t _seed) : state(_seed) { }
+
+		uint64_t Next()
+		{
+			uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+		uint64_t Range(uint64_t _min, uint64_t _max) { return _min + Next() % (_max - _min + 1); }
+		bool Chance(uint64_t _percent) { return Next() % 100 < _percent; }
+	};
+
+	//Counts a failure and prints _what unless _condition holds; returns _condition
+	bool Expect(bool _condition, const std::string& _what);
+
+	//Prints how many checks failed and returns the exit code of the test
+	int Finish(std::string_view _name);
+
+	//A variable generated programs may read without declaring it, such as an engine input
+	struct ProgramInput
+	{
+		std::string name;
+		bool isFloat;
+	};
+
+	//Generates a program that parses, resolves and checks without diagnostics: lets of ints and floats, nested
+	//blocks and expression statements. Runtime errors are not avoided; integer extremes, division and modulo by
+	//zero and by -1 are generated on purpose.
+	std::string GenerateProgram(Random& _random, const std::vector<ProgramInput>& _inputs = {});
+
+	//One line per node of the tree under _block, in preorder, with its position and exact value, so any two trees
+	//that differ give different text. Walks with an explicit stack, deep trees cannot overflow it.
+	std::string DescribeTree(Block* _block);
+
+	std::string PrintDiagnostics(const Diagnostics& _diagnostics);
+};
@@ -1,17 +1,41 @@
 #include "pch.h"
-#include "typesystem.h"
+#include "Utilities.h"
+#include "Typesystem.h"
 
 namespace ede::typesystem
 {
-    std::string PrimitiveType::ToString()
-    {
+	std::string_view PrimitiveType::GetName()
+	{
 		switch (id)
 		{
 			case PrimitiveID::UNIT: return "unit";
 			case PrimitiveID::INT: return "int";
 			case PrimitiveID::FLOAT: return "float";
+			case PrimitiveID::BOOL: return "bool";
 		}
 
 		return "UNKONWN";
-    }
+	}
+
+	PrimitiveType* GetPrimitiveType(PrimitiveID _id)
+	{
+		static PrimitiveType PRIMITIVES[] = {
+			PrimitiveType(PrimitiveID::UNIT), PrimitiveType(PrimitiveID::INT),
+			PrimitiveType(PrimitiveID::FLOAT), PrimitiveType(PrimitiveID::BOOL)
+		};
+
+		return &PRIMITIVES[(size_t)_id];
+	}
+
+	Type* LookupType(ede::utilities::Symbol _name)
+	{
+		static const ede::utilities::Symbol INT_SYMBOL = ede::utilities::Intern("int"), FLOAT_SYMBOL = ede::utilities::Intern("float"),
+			BOOL_SYMBOL = ede::utilities::Intern("bool"), UNIT_SYMBOL = ede::utilities::Intern("unit");
+
+		if (_name == INT_SYMBOL) { return GetPrimitiveType(PrimitiveID::INT); }
+		else if (_name == FLOAT_SYMBOL) { return GetPrimitiveType(PrimitiveID::FLOAT); }
+		else if (_name == BOOL_SYMBOL) { return GetPrimitiveType(PrimitiveID::BOOL); }
+		else if (_name == UNIT_SYMBOL) { return GetPrimitiveType(PrimitiveID::UNIT); }
+		else { return nullptr; }
+	}
 };
@@ -3,7 +3,7 @@
 namespace ede::typesystem
 {
 	enum class TypeID { PRIMITIVE };
-	enum class PrimitiveID { UNIT, INT, FLOAT };
+	enum class PrimitiveID { UNIT, INT, FLOAT, BOOL };
 
 	class Type
 	{
@@ -13,7 +13,9 @@ namespace ede::typesystem
 	public:
 		TypeID GetID() { return id; }
 
-		virtual std::string ToString() = 0;
+		//Types live for the whole process, so the view never dangles
+		virtual std::string_view GetName() = 0;
+		std::string ToString() { return std::string(GetName()); }
 	};
 
 	class PrimitiveType : public Type
@@ -23,6 +25,12 @@ namespace ede::typesystem
 		PrimitiveType(PrimitiveID _id) : Type(TypeID::PRIMITIVE), id(_id) { }
 		PrimitiveID GetID() { return id; }
 
-		std::string ToString();
+		std::string_view GetName();
 	};
+
+	//Types are interned: every type exists exactly once, so two types are equal iff their pointers are
+	PrimitiveType* GetPrimitiveType(PrimitiveID _id);
+
+	//Returns the type with the given name, or nullptr if there is none
+	Type* LookupType(ede::utilities::Symbol _name);
 }
\ No newline at end of file
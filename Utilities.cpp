@@ -1,20 +1,81 @@
 #include "pch.h"
 #include "Utilities.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace ede::utilities
 {
-	typedef std::tuple<DiagnosticType, Position, std::string> Diagnostic;
-	std::vector<Diagnostic> diagnostics;
+	Diagnostics::Diagnostics(size_t _capacity, bool _concurrent) : entries(), count(0), capacity(_capacity), concurrent(_concurrent)
+	{
+		if (concurrent)
+			entries.resize(capacity, Diagnostic{ DiagnosticType::ERROR_ExpectedStmt, Position(0, 0), {} });
+	}
 
-	void PushDiagnostic(DiagnosticType _type, Position _pos, std::string _msg) { diagnostics.push_back(Diagnostic(_type, _pos, _msg)); }
-	
-	void PrintDiagnostics()
+	void Diagnostics::Push(DiagnosticType _type, Position _pos, std::string_view _arg0, std::string_view _arg1, std::string_view _arg2)
+	{
+		Diagnostic diagnostic{ _type, _pos, { _arg0, _arg1, _arg2 } };
+
+		if (concurrent)
+		{
+			size_t index = count.fetch_add(1, std::memory_order_relaxed);
+			if (index < capacity) { entries[index] = diagnostic; }
+		}
+		else
+		{
+			size_t index = count.load(std::memory_order_relaxed);
+			count.store(index + 1, std::memory_order_relaxed);
+			if (index < capacity) { entries.push_back(diagnostic); }
+		}
+	}
+
+	void Diagnostics::Clear()
 	{
-		for (auto [type, pos, msg] : diagnostics)
+		count.store(0, std::memory_order_relaxed);
+		if (!concurrent) { entries.clear(); }
+	}
+
+	std::string Diagnostics::FormatMessage(const Diagnostic& _diagnostic)
+	{
+		const std::string_view* args = _diagnostic.args;
+
+		switch (_diagnostic.type)
 		{
+			case DiagnosticType::ERROR_TypeMismatch: return "expected " + std::string(args[0]) + ", found " + std::string(args[1]);
+			case DiagnosticType::ERROR_InvalidInput: return std::string(args[0]) + " expects " + std::string(args[1]) + ", found " + std::string(args[2]);
+			default:
+			{
+				//Non-empty arguments separated by spaces
+				std::string message;
+
+				for (size_t i = 0; i < 3; i++)
+				{
+					if (args[i].empty()) { continue; }
+					if (!message.empty()) { message += ' '; }
+					message += args[i];
+				}
+
+				return message;
+			}
+		}
+	}
+
+	void Diagnostics::Print(std::ostream& _stream) const
+	{
+		for (const Diagnostic& diagnostic : GetDiagnostics())
+		{
+			Position pos = diagnostic.position;
 			std::string header = pos.ToString() + " ";
 
-			switch (type)
+			switch (diagnostic.type)
 			{
 				case DiagnosticType::ERROR_IntLitOutOfRange: header += "<ERROR> Integer Literal Out Of Range"; break;
 				case DiagnosticType::ERROR_FloatLitOutOfRange: header += "<ERROR> Float Literal Out Of Range"; break;
@@ -28,13 +89,204 @@ namespace ede::utilities
 				case DiagnosticType::ERROR_ExpectedTypeName: header += "<ERROR> Expected a type name"; break;
 				case DiagnosticType::ERROR_ExpectedEquals: header += "<ERROR> Expected an equals symbol"; break;
 				case DiagnosticType::ERROR_ExpectedExpr: header += "<ERROR> Expected an expression"; break;
+				case DiagnosticType::ERROR_DivisionByZero: header += "<ERROR> Division by zero"; break;
+				case DiagnosticType::ERROR_IntegerOverflow: header += "<ERROR> Integer overflow"; break;
+				case DiagnosticType::ERROR_InvalidOperands: header += "<ERROR> Invalid operands for operator"; break;
+				case DiagnosticType::ERROR_UnknownType: header += "<ERROR> Unknown type"; break;
+				case DiagnosticType::ERROR_TypeMismatch: header += "<ERROR> Type mismatch"; break;
+				case DiagnosticType::ERROR_ExpectedClosingBrace: header += "<ERROR> Expected a closing brace"; break;
+				case DiagnosticType::ERROR_UndeclaredIdentifier: header += "<ERROR> Undeclared identifier"; break;
+				case DiagnosticType::ERROR_UseBeforeDeclaration: header += "<ERROR> Variable used before its declaration"; break;
+				case DiagnosticType::ERROR_Shadowing: header += "<ERROR> Declaration shadows an existing variable"; break;
+				case DiagnosticType::ERROR_InvalidInput: header += "<ERROR> Invalid input value"; break;
+				case DiagnosticType::ERROR_NestingTooDeep: header += "<ERROR> Nesting exceeds the depth limit"; break;
 				default: header += "Unknown Diagnostic"; break;
 			}
 
-			std::cout << header << " : " << msg << std::endl;
+			_stream << header << " : " << FormatMessage(diagnostic) << std::endl;
 		}
+
+		if (GetDroppedCount() != 0)
+			_stream << GetDroppedCount() << " more diagnostics were omitted" << std::endl;
 	}
 	
+	Arena::Arena(size_t _initialChunkSize) : head(nullptr), cursor(nullptr), limit(nullptr), nextChunkSize(_initialChunkSize),
+		allocationCount(0), bytesAllocated(0), bytesReserved(0), chunkCount(0) { }
+
+	void Arena::Adopt(Arena& _other)
+	{
+		if (!_other.head) { return; }
+
+		Chunk* tail = _other.head;
+		while (tail->next) { tail = tail->next; }
+
+		//Keep our own chunk in front so allocation continues where it left off
+		if (head)
+		{
+			tail->next = head->next;
+			head->next = _other.head;
+		}
+		else
+		{
+			head = _other.head;
+			cursor = _other.cursor;
+			limit = _other.limit;
+		}
+
+		allocationCount += _other.allocationCount;
+		bytesAllocated += _other.bytesAllocated;
+		bytesReserved += _other.bytesReserved;
+		chunkCount += _other.chunkCount;
+
+		_other.head = nullptr;
+		_other.cursor = _other.limit = nullptr;
+		_other.allocationCount = _other.bytesAllocated = _other.bytesReserved = _other.chunkCount = 0;
+	}
+
+	Arena::~Arena()
+	{
+		while (head)
+		{
+			Chunk* next = head->next;
+			::operator delete(head);
+			head = next;
+		}
+	}
+
+	void Arena::Grow(size_t _minSize)
+	{
+		static const size_t MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+		size_t size = std::max(nextChunkSize, _minSize + sizeof(Chunk));
+		Chunk* chunk = (Chunk*)::operator new(size);
+		chunk->next = head;
+		chunk->size = size;
+		head = chunk;
+
+		cursor = (char*)(chunk + 1);
+		limit = (char*)chunk + size;
+		nextChunkSize = std::min(nextChunkSize * 2, MAX_CHUNK_SIZE);
+		bytesReserved += size;
+		chunkCount++;
+	}
+
+	class SymbolTable
+	{
+		std::shared_mutex mutex;
+		std::unordered_map<std::string_view, Symbol> symbols;
+		std::vector<std::string_view> texts;
+		Arena storage;
+	public:
+		Symbol Intern(std::string_view _text)
+		{
+			{
+				std::shared_lock<std::shared_mutex> lock(mutex);
+				auto search = symbols.find(_text);
+				if (search != symbols.end()) { return search->second; }
+			}
+
+			std::unique_lock<std::shared_mutex> lock(mutex);
+			auto search = symbols.find(_text);
+			if (search != symbols.end()) { return search->second; }
+
+			std::string_view text = storage.NewString(_text);
+			Symbol symbol = (Symbol)texts.size();
+
+			texts.push_back(text);
+			symbols.emplace(text, symbol);
+			return symbol;
+		}
+
+		std::string_view GetText(Symbol _symbol)
+		{
+			std::shared_lock<std::shared_mutex> lock(mutex);
+			return texts[_symbol];
+		}
+	};
+
+	SymbolTable& GetSymbolTable()
+	{
+		static SymbolTable table;
+		return table;
+	}
+
+	Symbol Intern(std::string_view _text)
+	{
+		//Each thread keeps its own map in front of the shared table, so repeated names never touch its lock
+		thread_local std::unordered_map<std::string_view, Symbol> cache;
+
+		auto search = cache.find(_text);
+		if (search != cache.end()) { return search->second; }
+
+		SymbolTable& table = GetSymbolTable();
+		Symbol symbol = table.Intern(_text);
+		cache.emplace(table.GetText(symbol), symbol);
+		return symbol;
+	}
+	std::string_view GetSymbolText(Symbol _symbol) { return GetSymbolTable().GetText(_symbol); }
+
+#ifdef _WIN32
+	MappedFile::MappedFile(const std::string& _path) : data(nullptr), size(0), isOpen(false), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+	{
+		fileHandle = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE) { return; }
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize)) { return; }
+		if (fileSize.QuadPart == 0) { isOpen = true; return; }
+
+		mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mappingHandle) { return; }
+
+		data = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		if (data)
+		{
+			size = (size_t)fileSize.QuadPart;
+			isOpen = true;
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (data) { UnmapViewOfFile(data); }
+		if (mappingHandle) { CloseHandle(mappingHandle); }
+		if (fileHandle != INVALID_HANDLE_VALUE) { CloseHandle(fileHandle); }
+	}
+#else
+	MappedFile::MappedFile(const std::string& _path) : data(nullptr), size(0), isOpen(false)
+	{
+		int fd = open(_path.c_str(), O_RDONLY);
+		struct stat info;
+
+		if (fd < 0 || fstat(fd, &info) != 0)
+		{
+			if (fd >= 0) { close(fd); }
+			return;
+		}
+
+		if (info.st_size == 0) { isOpen = true; }
+		else
+		{
+			void* mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (mapping != MAP_FAILED)
+			{
+				madvise(mapping, (size_t)info.st_size, MADV_SEQUENTIAL);
+				data = (const char*)mapping;
+				size = (size_t)info.st_size;
+				isOpen = true;
+			}
+		}
+
+		close(fd);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (data) { munmap((void*)data, size); }
+	}
+#endif
+
 	void StringBuilder::Write(const std::string& _str) { result += _str; }
 	void StringBuilder::WriteLine(const std::string& _str) { result += '\n' + indent + "|-" + _str; }
 	void StringBuilder::Indent() { indent.push_back(' '); }
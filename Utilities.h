@@ -23,10 +23,169 @@ namespace ede::utilities
 		ERROR_ExpectedTypeName,
 		ERROR_ExpectedEquals,
 		ERROR_ExpectedExpr,
+		ERROR_DivisionByZero,
+		ERROR_IntegerOverflow,
+		ERROR_InvalidOperands,
+		ERROR_UnknownType,
+		ERROR_TypeMismatch,
+		ERROR_ExpectedClosingBrace,
+		ERROR_UndeclaredIdentifier,
+		ERROR_UseBeforeDeclaration,
+		ERROR_Shadowing,
+		ERROR_InvalidInput,
+		ERROR_NestingTooDeep,
 	};
 
-	void PushDiagnostic(DiagnosticType, Position, std::string);
-	void PrintDiagnostics();
+	//Non-owning view over a contiguous array, typically one allocated from an Arena
+	template<typename T>
+	struct ArrayView
+	{
+		T* data;
+		size_t size;
+
+		ArrayView() : data(nullptr), size(0) { }
+		ArrayView(T* _data, size_t _size) : data(_data), size(_size) { }
+
+		T* begin() const { return data; }
+		T* end() const { return data + size; }
+		T& operator[](size_t _index) const { return data[_index]; }
+		bool empty() const { return size == 0; }
+	};
+
+	struct Diagnostic
+	{
+		DiagnosticType type;
+		Position position;
+		std::string_view args[3]; //Message arguments, formatted into the message only when it is printed
+	};
+
+	//Collects the diagnostics of one compilation. Arguments are stored as views, so they must outlive the sink;
+	//source spans, symbol text and string literals all do. At most _capacity diagnostics are kept, further ones
+	//are only counted. In concurrent mode the storage is allocated up front and Push is lock-free, so several
+	//threads may report at once; entries are then kept in arrival order and may only be read once every
+	//reporting thread has finished.
+	class Diagnostics
+	{
+		std::vector<Diagnostic> entries;
+		std::atomic<size_t> count;
+		size_t capacity;
+		bool concurrent;
+	public:
+		static const size_t DEFAULT_CAPACITY = 1024;
+
+		Diagnostics(size_t _capacity = DEFAULT_CAPACITY, bool _concurrent = false);
+
+		Diagnostics(const Diagnostics&) = delete;
+		Diagnostics& operator=(const Diagnostics&) = delete;
+
+		void Push(DiagnosticType _type, Position _pos, std::string_view _arg0 = std::string_view(), std::string_view _arg1 = std::string_view(), std::string_view _arg2 = std::string_view());
+
+		//Number of diagnostics reported, including those dropped beyond the capacity
+		size_t GetCount() const { return count.load(std::memory_order_relaxed); }
+		size_t GetDroppedCount() const { return GetCount() > capacity ? GetCount() - capacity : 0; }
+		ArrayView<const Diagnostic> GetDiagnostics() const { return ArrayView<const Diagnostic>(entries.data(), std::min(GetCount(), capacity)); }
+
+		static std::string FormatMessage(const Diagnostic& _diagnostic);
+		void Print(std::ostream& _stream = std::cout) const;
+		void Clear();
+	};
+
+	//Bump allocator that hands out memory from a growing list of chunks and releases all of it at once.
+	//Objects placed in an arena never have their destructors run, so they must be trivially destructible.
+	class Arena
+	{
+		struct Chunk { Chunk* next; size_t size; };
+
+		Chunk* head;
+		char* cursor, * limit;
+		size_t nextChunkSize;
+		size_t allocationCount, bytesAllocated, bytesReserved, chunkCount;
+
+		void Grow(size_t _minSize);
+	public:
+		Arena(size_t _initialChunkSize = 64 * 1024);
+		~Arena();
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		void* Allocate(size_t _size, size_t _align)
+		{
+			char* result = (char*)(((uintptr_t)cursor + (_align - 1)) & ~(uintptr_t)(_align - 1));
+
+			if (!cursor || result + _size > limit)
+			{
+				Grow(_size + _align);
+				result = (char*)(((uintptr_t)cursor + (_align - 1)) & ~(uintptr_t)(_align - 1));
+			}
+
+			cursor = result + _size;
+			allocationCount++;
+			bytesAllocated += _size;
+			return result;
+		}
+
+		template<typename T, typename... Args>
+		T* New(Args&&... _args)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed");
+			return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(_args)...);
+		}
+
+		template<typename T>
+		ArrayView<T> NewArray(const T* _items, size_t _count)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Arena arrays are copied bytewise");
+			T* data = _count ? (T*)Allocate(sizeof(T) * _count, alignof(T)) : nullptr;
+			if (_count) { std::memcpy(data, _items, sizeof(T) * _count); }
+			return ArrayView<T>(data, _count);
+		}
+
+		std::string_view NewString(std::string_view _str)
+		{
+			char* data = _str.empty() ? nullptr : (char*)Allocate(_str.size(), 1);
+			if (data) { std::memcpy(data, _str.data(), _str.size()); }
+			return std::string_view(data, _str.size());
+		}
+
+		//Takes over every chunk of _other, which is left empty; objects allocated from it stay valid for the lifetime of this arena
+		void Adopt(Arena& _other);
+
+		size_t GetAllocationCount() { return allocationCount; }
+		size_t GetBytesAllocated() { return bytesAllocated; }
+		size_t GetBytesReserved() { return bytesReserved; }
+		size_t GetChunkCount() { return chunkCount; }
+	};
+
+	//Interned name. Equal names always map to the same symbol, so comparing names is an integer compare.
+	typedef uint32_t Symbol;
+	static const Symbol INVALID_SYMBOL = UINT32_MAX;
+
+	//Interns _text in the process-wide symbol table; thread-safe
+	Symbol Intern(std::string_view _text);
+
+	//Returns the text of an interned symbol; the view stays valid for the lifetime of the process
+	std::string_view GetSymbolText(Symbol _symbol);
+
+	//Read-only view of a whole file backed by a memory mapping, so pages are only loaded as they are touched
+	class MappedFile
+	{
+		const char* data;
+		size_t size;
+		bool isOpen;
+#ifdef _WIN32
+		void* fileHandle, * mappingHandle;
+#endif
+	public:
+		MappedFile(const std::string& _path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool IsOpen() { return isOpen; }
+		std::string_view GetView() { return std::string_view(data, size); }
+	};
 
 	class StringBuilder
 	{
@@ -3,7 +3,9 @@
 
 namespace ede::ast
 {
-	std::string BinopOPToString(BinopOP _op)
+	std::string BinopOPToString(BinopOP _op) { return std::string(GetBinopSymbol(_op)); }
+
+	std::string_view GetBinopSymbol(BinopOP _op)
 	{
 		switch (_op)
 		{
@@ -18,43 +20,77 @@ namespace ede::ast
 
 	void Binop::ToString(StringBuilder& _builder)
 	{
-		_builder.WriteLine("Binop");
-		_builder.Indent();
+		//Binops still being printed, with the number of operands done; operands that are not Binops print themselves
+		std::vector<std::pair<Binop*, int>> stack;
+		stack.emplace_back(this, 0);
 
-		_builder.WriteLine("OP: " + BinopOPToString(op));
+		while (!stack.empty())
+		{
+			Binop* binop = stack.back().first;
+			Expression* operand;
 
-		_builder.WriteLine("Left");
-		_builder.Indent();
-		left->ToString(_builder);
-		_builder.Dedent();
+			switch (stack.back().second++)
+			{
+				case 0:
+				{
+					_builder.WriteLine("Binop");
+					_builder.Indent();
+					_builder.WriteLine("OP: " + BinopOPToString(binop->op));
+					_builder.WriteLine("Left");
+					operand = binop->left;
+				} break;
+				case 1:
+				{
+					_builder.Dedent();
+					_builder.WriteLine("Right");
+					operand = binop->right;
+				} break;
+				default:
+				{
+					_builder.Dedent();
+					_builder.Dedent();
+					stack.pop_back();
+				} continue;
+			}
 
-		_builder.WriteLine("Right");
-		_builder.Indent();
-		right->ToString(_builder);
-		_builder.Dedent();
+			_builder.Indent();
 
-		_builder.Dedent();
+			if (operand->GetID() == ExprID::BINOP) { stack.emplace_back((Binop*)operand, 0); }
+			else { operand->ToString(_builder); }
+		}
 	}
 	
-	void Literal::ToString(StringBuilder& _builder)
+	std::string Value::ToString() const
 	{
-		std::string valueStr = std::visit(overloaded{
-			[](UNIT _val) { return std::string("()"); },
-			[](INT _val) { return std::to_string(_val); },
-			[](FLOAT _val) { return std::to_string(_val); },
-			[](BOOL _val) { return std::to_string(_val); },
-			}, value);
+		switch (type)
+		{
+			case ValueType::INT: return std::to_string(as.i);
+			case ValueType::FLOAT: return std::to_string(as.f);
+			case ValueType::BOOL: return std::to_string(as.b);
+			default: return "()";
+		}
+	}
 
-		_builder.WriteLine("Literal: " + valueStr);
+	void Literal::ToString(StringBuilder& _builder)
+	{
+		_builder.WriteLine("Literal: " + value.ToString());
 	}
 	
+	void Identifier::ToString(StringBuilder& _builder)
+	{
+		_builder.WriteLine("Identifier: " + std::string(GetSymbolText(name)));
+	}
+
 	void Block::ToString(StringBuilder& _builder)
 	{
 		_builder.WriteLine("Block");
 		_builder.Indent();
 
 		for (auto stmt : statements)
-			stmt->ToString(_builder);
+		{
+			if (stmt) //Statements that failed to parse
+				stmt->ToString(_builder);
+		}
 
 		_builder.Dedent();
 	}
@@ -64,8 +100,8 @@ namespace ede::ast
 		_builder.WriteLine("Variable Declaration");
 		_builder.Indent();
 
-		_builder.WriteLine("VarName: " + varName);
-		_builder.WriteLine("TypeName: " + typeName);
+		_builder.WriteLine("VarName: " + std::string(GetSymbolText(varName)));
+		_builder.WriteLine("TypeName: " + std::string(GetSymbolText(typeName)));
 		
 		_builder.WriteLine("Expression: ");
 		_builder.Indent();
@@ -14,9 +14,53 @@ namespace ede::ast
 
 	enum class NodeID { STMT };
 	enum class StmtID { EXPR, BLOCK, VARDECL };
-	enum class ExprID { LITERAL, BINOP };
+	enum class ExprID { LITERAL, BINOP, IDENTIFIER };
 	enum class BinopOP { ADD, SUB, MUL, DIV, MOD };
 
+	//Concrete operation selected for a Binop by the checker
+	enum class BinopKernel : uint8_t
+	{
+		NONE,
+		ADD_INT, SUB_INT, MUL_INT, DIV_INT, MOD_INT,
+		ADD_FLOAT, SUB_FLOAT, MUL_FLOAT, DIV_FLOAT, MOD_FLOAT,
+	};
+	enum class ValueType : uint8_t { UNIT, INT, FLOAT, BOOL };
+
+#pragma region Value
+	//Tagged value shared by literals and the evaluators: a 64-bit payload followed by a one byte tag.
+	//INT needs the whole payload, so the tag cannot be packed into it; the type is still trivially
+	//copyable and small enough to be passed and returned in a pair of registers.
+	class Value
+	{
+		union { INT i; FLOAT f; BOOL b; } as;
+		ValueType type;
+	public:
+		Value() : as{ 0 }, type(ValueType::UNIT) { }
+		Value(UNIT) : as{ 0 }, type(ValueType::UNIT) { }
+		Value(INT _val) : type(ValueType::INT) { as.i = _val; }
+		Value(FLOAT _val) : type(ValueType::FLOAT) { as.f = _val; }
+		Value(BOOL _val) : type(ValueType::BOOL) { as.i = 0; as.b = _val; }
+
+		ValueType GetType() const { return type; }
+		bool IsUnit() const { return type == ValueType::UNIT; }
+		bool IsInt() const { return type == ValueType::INT; }
+		bool IsFloat() const { return type == ValueType::FLOAT; }
+		bool IsBool() const { return type == ValueType::BOOL; }
+
+		INT AsInt() const { return as.i; }
+		FLOAT AsFloat() const { return as.f; }
+		BOOL AsBool() const { return as.b; }
+
+		//Raw payload, for bitwise comparisons
+		uint64_t GetBits() const { uint64_t bits; std::memcpy(&bits, &as, sizeof(bits)); return bits; }
+
+		std::string ToString() const;
+	};
+
+	static_assert(sizeof(Value) == 16 && std::is_trivially_copyable_v<Value>, "Value must stay a compact POD");
+#pragma endregion
+
+	//All nodes are allocated from the Arena passed to parser::Parse and are released together with it
 #pragma region Node
 	class Node
 	{
@@ -27,6 +71,7 @@ namespace ede::ast
 	public:
 		NodeID GetID() { return id; }
 		Position GetPosition() { return position; }
+		void SetPosition(Position _pos) { position = _pos; }
 
 		virtual void ToString(StringBuilder& _builder) = 0;
 	};
@@ -49,11 +94,16 @@ namespace ede::ast
 	class Expression : public Statement
 	{
 		ExprID id;
+		Type* type;
 	protected:
-		Expression(ExprID _id, Position _pos) : Statement(StmtID::EXPR, _pos), id(_id) { }
+		Expression(ExprID _id, Position _pos) : Statement(StmtID::EXPR, _pos), id(_id), type(nullptr) { }
 	public:
 		ExprID GetID() { return id; }
 
+		//Set by the checker; nullptr until then or if the expression is ill-typed
+		Type* GetType() { return type; }
+		void SetType(Type* _type) { type = _type; }
+
 		virtual void ToString(StringBuilder& _builder) = 0;
 	};
 #pragma endregion
@@ -61,12 +111,11 @@ namespace ede::ast
 #pragma region Block
 	class Block : public Statement
 	{
-		std::vector<Statement*> statements;
+		ArrayView<Statement*> statements;
 	public:
-		Block(std::vector<Statement*>& _stmts, Position _pos) : Statement(StmtID::BLOCK, _pos), statements(_stmts) { }
-		~Block() { DELETE_VEC(statements); }
+		Block(ArrayView<Statement*> _stmts, Position _pos) : Statement(StmtID::BLOCK, _pos), statements(_stmts) { }
 
-		const std::vector<Statement*>& GetStatements() { return statements; }
+		ArrayView<Statement*> GetStatements() { return statements; }
 		
 		void ToString(StringBuilder& _builder);
 	};
@@ -75,15 +124,25 @@ namespace ede::ast
 #pragma region VarDecl
 	class VarDecl : public Statement
 	{
-		std::string varName, typeName;
+		Symbol varName, typeName;
 		Expression* expr;
+		Type* type;
+		uint32_t slot;
 	public:
-		VarDecl(std::string _varName, std::string _typeName, Expression* _expr, Position _pos) : Statement(StmtID::VARDECL, _pos), varName(_varName), typeName(_typeName), expr(_expr) { }
-		~VarDecl() { delete expr; }
+		VarDecl(Symbol _varName, Symbol _typeName, Expression* _expr, Position _pos) : Statement(StmtID::VARDECL, _pos), varName(_varName), typeName(_typeName), expr(_expr), type(nullptr), slot(0) { }
 
-		std::string GetVarName() { return varName; }
-		std::string GetTypeName() { return typeName; }
+		Symbol GetVarName() { return varName; }
+		Symbol GetTypeName() { return typeName; }
 		Expression* GetExpr() { return expr; }
+		void SetExpr(Expression* _expr) { expr = _expr; }
+
+		//The declared type, resolved by the checker
+		Type* GetType() { return type; }
+		void SetType(Type* _type) { type = _type; }
+
+		//Index of the binding in its frame, assigned by the resolver
+		uint32_t GetSlot() { return slot; }
+		void SetSlot(uint32_t _slot) { slot = _slot; }
 
 		void ToString(StringBuilder& _builder);
 	};
@@ -94,13 +153,17 @@ namespace ede::ast
 	{
 		Expression* left, * right;
 		BinopOP op;
+		BinopKernel kernel;
 	public:
-		Binop(Expression* _left, BinopOP _op, Expression* _right, Position _pos) : Expression(ExprID::BINOP, _pos), left(_left), right(_right), op(_op) { }
-		~Binop() { delete left; delete right; };
+		Binop(Expression* _left, BinopOP _op, Expression* _right, Position _pos) : Expression(ExprID::BINOP, _pos), left(_left), right(_right), op(_op), kernel(BinopKernel::NONE) { }
 
 		BinopOP GetOP() { return op; }
+		BinopKernel GetKernel() { return kernel; }
+		void SetKernel(BinopKernel _kernel) { kernel = _kernel; }
 		Expression* GetLeft() { return left; }
 		Expression* GetRight() { return right; }
+		void SetLeft(Expression* _left) { left = _left; }
+		void SetRight(Expression* _right) { right = _right; }
 
 		void ToString(StringBuilder& _builder);
 	};
@@ -109,14 +172,72 @@ namespace ede::ast
 #pragma region Literal
 	class Literal : public Expression
 	{
-		typedef std::variant<UNIT, INT, FLOAT, BOOL> kind;
-		kind value;
+		Value value;
 	public:
-		Literal(kind _val, Position _pos) : Expression(ExprID::LITERAL, _pos), value(_val) { }
+		Literal(Value _val, Position _pos) : Expression(ExprID::LITERAL, _pos), value(_val) { }
 
-		kind GetValue() { return value; }
+		const Value& GetValue() { return value; }
 
 		void ToString(StringBuilder& _builder);
 	};
 #pragma endregion
+
+#pragma region Identifier
+	class Identifier : public Expression
+	{
+		Symbol name;
+		VarDecl* decl;
+	public:
+		Identifier(Symbol _name, Position _pos) : Expression(ExprID::IDENTIFIER, _pos), name(_name), decl(nullptr) { }
+
+		Symbol GetName() { return name; }
+
+		//The declaration this identifier refers to, linked by the resolver; nullptr if it could not be resolved
+		VarDecl* GetDecl() { return decl; }
+		void SetDecl(VarDecl* _decl) { decl = _decl; }
+
+		void ToString(StringBuilder& _builder);
+	};
+#pragma endregion
+
+	std::string_view GetBinopSymbol(BinopOP _op);
+	std::string BinopOPToString(BinopOP _op);
+
+	//Calls _visit on every node of the expression under _root, operands before their Binop and left before right,
+	//which is the order all passes evaluate in. The walk keeps its path in _stack instead of recursing, so trees of
+	//any height only cost memory; passes hand in the same scratch stack for every expression.
+	//Stops as soon as _visit returns false, and returns false in that case.
+	template<typename Visit>
+	bool VisitPostOrder(Expression* _root, std::vector<Expression*>& _stack, Visit&& _visit)
+	{
+		size_t base = _stack.size();
+		Expression* next = _root, * last = nullptr;
+
+		for (;;)
+		{
+			for (; next; next = next->GetID() == ExprID::BINOP ? ((Binop*)next)->GetLeft() : nullptr)
+				_stack.push_back(next);
+
+			if (_stack.size() == base) { return true; }
+
+			//Coming back from the left operand, the right one is next
+			Expression* top = _stack.back();
+			Expression* right = top->GetID() == ExprID::BINOP ? ((Binop*)top)->GetRight() : nullptr;
+
+			if (right && right != last)
+			{
+				next = right;
+				continue;
+			}
+
+			if (!_visit(top))
+			{
+				_stack.resize(base);
+				return false;
+			}
+
+			last = top;
+			_stack.pop_back();
+		}
+	}
 };
\ No newline at end of file
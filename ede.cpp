@@ -1,24 +1,101 @@
 #include "pch.h"
 #include "Utilities.h"
-#include "Parser.h"
+#include "Driver.h"
 
 using namespace ede;
 using namespace ede::utilities;
 
-int main()
+//Usage: ede [--fold] [--ast] [--no-run] [--no-jit] [--verify-jit] [--parallel-parse] [--stats[=json]] [--cache directory] [-j jobs]
+//           [--format tree|compact|json] [--ast-dir directory] [--max-depth n] [--max-block-depth n] [files or directories...]
+//--format selects the format of --ast; --ast-dir implies --ast and writes each dump to a file of the directory.
+//Any other argument starting with - is rejected with exit code 2, like a mistyped option.
+int main(int argc, char** argv)
 {
-	std::ifstream file("Examples\\ex1.ede");
+	driver::Options options;
+	std::vector<std::string> inputs;
+	bool statsJson = false;
 
-	auto node = parser::Parse(std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()), 4);
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg(argv[i]);
 
-	StringBuilder sb;
-	node->ToString(sb);
+		if (arg == "--fold") { options.fold = true; }
+		else if (arg == "--ast") { options.printAst = true; }
+		else if (arg == "--ast-dir" && i + 1 < argc) { options.printAst = true; options.astDirectory = argv[++i]; }
+		else if (arg == "--format" && i + 1 < argc)
+		{
+			if (!dump::FindFormat(argv[++i], options.astFormat))
+			{
+				std::cerr << "Unknown format " << argv[i] << std::endl;
+				return 2;
+			}
+		}
+		else if (arg == "--no-run") { options.run = false; }
+		else if (arg == "--no-jit") { options.jit = false; }
+		else if (arg == "--verify-jit") { options.verifyJit = true; }
+		else if (arg == "--parallel-parse") { options.parallelParse = true; }
+		else if (arg == "--stats" || arg == "--stats=text") { options.stats = true; }
+		else if (arg == "--stats=json") { options.stats = statsJson = true; }
+		else if (arg == "--cache" && i + 1 < argc) { options.cacheDirectory = argv[++i]; }
+		else if (arg == "-j" && i + 1 < argc) { options.jobs = std::strtoul(argv[++i], nullptr, 10); }
+		else if (arg == "--max-depth" && i + 1 < argc) { options.limits.maxExpressionDepth = std::strtoul(argv[++i], nullptr, 10); }
+		else if (arg == "--max-block-depth" && i + 1 < argc) { options.limits.maxBlockDepth = std::strtoul(argv[++i], nullptr, 10); }
+		else if (arg.size() > 1 && arg[0] == '-')
+		{
+			//Also catches options missing their value
+			std::cerr << "Unknown argument " << arg << std::endl;
+			return 2;
+		}
+		else { inputs.push_back(argv[i]); }
+	}
 
-	std::cout << sb.GetString() << std::endl;
+	if (inputs.empty())
+		inputs.push_back("Examples/ex1.ede");
 
-	delete node;
+	std::vector<std::string> files = driver::CollectSources(inputs);
 
-	file.close();
-	PrintDiagnostics();
-	return 0;
+	size_t bytes = 0, failed = 0, cached = 0;
+	double busy = 0;
+#ifndef EDE_NO_STATS
+	stats::Counters counters;
+#endif
+
+	//With --stats=json the JSON object is all that goes to stdout, so it can be piped as is
+	std::ostream& report = statsJson ? std::cerr : std::cout;
+
+	auto start = std::chrono::steady_clock::now();
+
+	driver::CompileFiles(files, options, report, [&](const driver::FileResult& _result)
+	{
+		bytes += _result.bytes;
+		busy += _result.seconds;
+		if (!_result.success) { failed++; }
+		if (_result.cached) { cached++; }
+#ifndef EDE_NO_STATS
+		counters.Add(_result.stats);
+#endif
+	});
+
+	double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	size_t jobs = options.jobs != 0 ? options.jobs : std::max<size_t>(1, std::thread::hardware_concurrency());
+	double megabytes = bytes / (1024.0 * 1024.0);
+
+	report << "Compiled " << files.size() << " files (" << failed << " failed, " << megabytes << " MB) in " << wall * 1000 << " ms on " << std::min(jobs, std::max<size_t>(files.size(), 1)) << " workers" << std::endl;
+	report << "Throughput: " << megabytes / wall << " MB/s, " << files.size() / wall << " files/s, speedup over serial " << (wall > 0 ? busy / wall : 0) << "x" << std::endl;
+
+	if (!options.cacheDirectory.empty())
+		report << "Cache: " << cached << " hits, " << files.size() - cached << " misses" << std::endl;
+
+	if (options.stats)
+	{
+#ifdef EDE_NO_STATS
+		std::cerr << "Statistics are not available, this build defines EDE_NO_STATS" << std::endl;
+#else
+		if (statsJson) { stats::PrintJson(counters, wall, std::cout); }
+		else { stats::PrintText(counters, wall, std::cout); }
+#endif
+	}
+
+	return failed == 0 ? 0 : 1;
 }
@@ -2,11 +2,29 @@
 
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <deque>
 #include <unordered_map>
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <sstream>
 #include <fstream>
 #include <variant>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <climits>
+#include <cmath>
+#include <type_traits>
+#include <functional>
 
 template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
 template<class... Ts> overloaded(Ts...)->overloaded<Ts...>;